@@ -22,6 +22,7 @@
 #include <functional>
 #include <regex>
 #include <thread>
+#include <atomic>
 #include <iomanip>
 #include <locale>
 #include <codecvt>
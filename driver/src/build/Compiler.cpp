@@ -11,52 +11,37 @@
 #include "src/generate/CppPackageGenerator.hpp"
 #include "src/primitive/string.hpp"
 
-birch::Compiler* compiler = nullptr;
-std::stringstream raw;
-
-birch::Compiler::Compiler(Package* package, const std::string& unit) :
+birch::Compiler::Compiler(Package* package, const std::string& unit,
+    const int jobs) :
     scope(new Scope(GLOBAL_SCOPE)),
     package(package),
-    unit(unit) {
+    unit(unit),
+    jobs(jobs) {
   //
 }
 
 void birch::Compiler::parse(bool includeHeaders) {
-  compiler = this;  // set global variable needed by parser for callbacks
   auto files = package->sources;
   if (includeHeaders) {
     files = package->files;
   }
-  for (auto file : files) {
-    raw.str("");
-    auto fd = fopen(file->path.c_str(), "r");
-    if (!fd) {
-      throw FileNotFoundException(file->path);
-    }
-    this->file = file;  // member variable needed by GNU Bison parser
-    yyrestart(fd);
-    yyreset();
-    try {
-      yyparse();
-    } catch (birch::Exception& e) {
-      yyerror(e.msg.c_str());
-    }
-    yylex_destroy();
-    fclose(fd);
-    this->file = nullptr;
-  }
-  compiler = nullptr;
+  forEach(files, [](File* file) { parse(file); });
 }
 
 void birch::Compiler::resolve() {
+  /* scoper and baser populate the package scope, and so must visit all
+   * files before any identifiers are resolved; resolution then only reads
+   * the package scope, and can proceed for each file independently */
   Scoper scoper;
   package->accept(&scoper);
 
   Baser baser;
   package->accept(&baser);
 
-  Resolver resolver;
-  package->accept(&resolver);
+  forEach(package->files, [this](File* file) {
+    Resolver resolver(package);
+    file->accept(&resolver);
+  });
 }
 
 void birch::Compiler::gen() {
@@ -68,56 +53,226 @@ void birch::Compiler::gen() {
   CppPackageGenerator hppOutput(stream, 0, true);
   CppGenerator cppOutput(stream, 0, false, false);
 
+  /* the generated code for a source file depends only on its own contents
+   * and on the declarations of the package and its dependencies, as
+   * captured by the headers; the build date of the driver is included so
+   * that an upgraded driver invalidates the cache, and the compilation unit
+   * so that switching units does not keep output generated under another */
+  std::string interface = __DATE__ " " __TIME__;
+  interface += "\n" + unit + "\n";
+  for (auto file : package->headers) {
+    interface += read_all(file->path);
+  }
+  if (unit == "balanced") {
+    /* the partition into units depends on the number of jobs */
+    int n = package->sources.size();
+    interface += std::to_string(std::max(std::min(jobs, n), 1)) + "\n";
+  }
+
   /* single birch header for whole package */
   stream.str("");
   birchOutput << package;
   path.replace_extension(".birch");
   write_all_if_different(path, stream.str());
+  interface += stream.str();
 
   /* single *.hpp header for whole package */
   stream.str("");
   hppOutput << package;
   path.replace_extension(".hpp");
   write_all_if_different(path, stream.str());
+  interface += stream.str();
+
+  /* determine which source files have changed since the last run */
+  path.replace_extension(".cache");
+  auto cachePath = path;
+  auto cache = readCache(cachePath, hash(interface));
+  std::unordered_map<std::string,std::string> hashes;
+  std::unordered_set<File*> changed;
+  for (auto file : package->sources) {
+    auto h = hash(read_all(file->path));
+    auto iter = cache.find(file->path);
+    if (iter == cache.end() || iter->second != h) {
+      changed.insert(file);
+    }
+    hashes.insert(std::make_pair(file->path, h));
+  }
+
+  /* source files removed since the last run also require the output that
+   * contained them to be regenerated */
+  std::unordered_set<std::string> removed;
+  for (auto pair : cache) {
+    if (hashes.find(pair.first) == hashes.end()) {
+      removed.insert(fs::path(pair.first).parent_path().string());
+    }
+  }
 
   if (unit == "unity") {
     /* sources go into one *.cpp file for the whole package */
-    stream.str("");
-    for (auto file : package->sources) {
-      cppOutput << file;
-    }
     path.replace_extension(".cpp");
-    write_all_if_different(path, stream.str());
+    if (!changed.empty() || !removed.empty() || !fs::exists(path)) {
+      stream.str("");
+      for (auto file : package->sources) {
+        cppOutput << file;
+      }
+      write_all_if_different(path, stream.str());
+    }
   } else if (unit == "file") {
     /* sources go into one *.cpp file for each *.birch file */
     for (auto file : package->sources) {
-      stream.str("");
-      cppOutput << file;
       path = file->path;
       path.replace_extension(".cpp");
-      write_all_if_different(path, stream.str());
+      if (changed.count(file) || !fs::exists(path)) {
+        stream.str("");
+        cppOutput << file;
+        write_all_if_different(path, stream.str());
+      }
+    }
+  } else if (unit == "balanced") {
+    /* sources go into one *.cpp file for each job; adding or removing a
+     * source file can shift the partition, regenerating all units */
+    auto reshaped = !removed.empty() || cache.size() != hashes.size();
+    std::map<std::string,std::list<File*>> sources;
+    std::unordered_set<std::string> dirty;
+    int i = 0, n = package->sources.size();
+    for (auto file : package->sources) {
+      auto source = balanced(tarName, i++, n, jobs).string();
+      sources[source].push_back(file);
+      if (changed.count(file)) {
+        dirty.insert(source);
+      }
+    }
+    for (auto pair : sources) {
+      path = pair.first;
+      if (dirty.count(pair.first) || reshaped || !fs::exists(path)) {
+        stream.str("");
+        for (auto file : pair.second) {
+          cppOutput << file;
+        }
+        write_all_if_different(path, stream.str());
+      }
+    }
+
+    /* remove units left over from a run with more jobs */
+    std::regex pattern("(.*)-[0-9]+\\.cpp");
+    std::smatch match;
+    for (auto& entry : fs::directory_iterator(fs::current_path())) {
+      auto name = entry.path().filename().string();
+      if (std::regex_match(name, match, pattern) && match[1] == tarName &&
+          !sources.count(name)) {
+        fs::remove(entry.path());
+      }
     }
   } else {
     /* sources go into one *.cpp file for each directory */
-    std::unordered_map<std::string,std::string> sources;
+    std::unordered_map<std::string,std::list<File*>> sources;
+    auto dirty = removed;
     for (auto file : package->sources) {
       auto dir = fs::path(file->path).parent_path().string();
-      auto iter = sources.find(dir);
-      if (iter == sources.end()) {
-        iter = sources.insert(std::make_pair(dir, std::string(""))).first;
+      sources[dir].push_back(file);
+      if (changed.count(file)) {
+        dirty.insert(dir);
       }
-      stream.str("");
-      cppOutput << file;
-      iter->second += stream.str();
     }
     for (auto pair : sources) {
       path = fs::path(pair.first) / tarName;
       path.replace_extension(".cpp");
-      write_all_if_different(path, pair.second);
+      if (dirty.count(pair.first) || !fs::exists(path)) {
+        stream.str("");
+        for (auto file : pair.second) {
+          cppOutput << file;
+        }
+        write_all_if_different(path, stream.str());
+      }
     }
   }
+
+  writeCache(cachePath, hash(interface), hashes);
+}
+
+fs::path birch::Compiler::balanced(const std::string& tarName, const int i,
+    const int n, const int jobs) {
+  auto units = std::max(std::min(jobs, n), 1);
+  fs::path path = tarName + "-" + std::to_string(i*units/n);
+  path.replace_extension(".cpp");
+  return path;
+}
+
+void birch::Compiler::parse(File* file) {
+  auto fd = fopen(file->path.c_str(), "r");
+  if (!fd) {
+    throw FileNotFoundException(file->path);
+  }
+  ParserState state(file);
+  yyscan_t scanner;
+  yylex_init_extra(&state, &scanner);
+  yyset_in(fd, scanner);
+  try {
+    yyparse(scanner);
+  } catch (birch::Exception& e) {
+    yyerror(&state, e.msg.c_str());
+  }
+  yylex_destroy(scanner);
+  fclose(fd);
 }
 
-void birch::Compiler::setRoot(Statement* root) {
-  this->file->root = root;
+void birch::Compiler::forEach(const std::list<File*>& files,
+    const std::function<void(File*)>& f) {
+  std::vector<File*> work(files.begin(), files.end());
+  std::vector<std::exception_ptr> errors(work.size());
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (auto i = next++; i < work.size(); i = next++) {
+      try {
+        f(work[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  auto nthreads = std::min(size_t(std::max(jobs, 1)), work.size());
+  std::vector<std::thread> threads;
+  for (size_t n = 1; n < nthreads; ++n) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+std::unordered_map<std::string,std::string> birch::Compiler::readCache(
+    const fs::path& path, const std::string& interface) {
+  std::unordered_map<std::string,std::string> cache;
+  if (fs::exists(path)) {
+    std::stringstream in(read_all(path));
+    std::string line;
+    if (std::getline(in, line) && line == interface) {
+      while (std::getline(in, line)) {
+        auto pos = line.find(' ');
+        if (pos != std::string::npos) {
+          cache.insert(std::make_pair(line.substr(pos + 1),
+              line.substr(0, pos)));
+        }
+      }
+    }
+  }
+  return cache;
+}
+
+void birch::Compiler::writeCache(const fs::path& path,
+    const std::string& interface,
+    const std::unordered_map<std::string,std::string>& hashes) {
+  std::stringstream out;
+  out << interface << '\n';
+  for (auto file : package->sources) {
+    out << hashes.at(file->path) << ' ' << file->path << '\n';
+  }
+  write_all_if_different(path, out.str());
 }
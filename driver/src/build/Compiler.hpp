@@ -20,8 +20,9 @@ public:
    *
    * @param package The package.
    * @param unit Compilation unit.
+   * @param jobs Number of threads to use when parsing and resolving.
    */
-  Compiler(Package* package, const std::string& unit);
+  Compiler(Package* package, const std::string& unit, const int jobs = 1);
 
   /**
    * Parse source files.
@@ -37,18 +38,28 @@ public:
 
   /**
    * Generate output code for all input files.
+   *
+   * C++ is regenerated only for the units that contain source files changed
+   * since the last run, as recorded in the cache. This saves code
+   * generation only: all files are still parsed and resolved beforehand, and
+   * compilation of the generated C++ is left to the build system, which
+   * recompiles a unit whenever it or the package header has changed.
    */
   void gen();
 
   /**
-   * Set the root statement of the current file.
-   */
-  void setRoot(Statement* root);
-
-  /**
-   * Current file being parsed (needed by GNU Bison parser).
+   * Name of the C++ source file into which a Birch source file is
+   * generated when the compilation unit is `balanced`. Source files are
+   * partitioned, in order, into one unit per job, each with roughly the same
+   * number of files.
+   *
+   * @param tarName Tar name of the package.
+   * @param i Index of the Birch source file among the package sources.
+   * @param n Number of package sources.
+   * @param jobs Number of jobs.
    */
-  File* file;
+  static fs::path balanced(const std::string& tarName, const int i,
+      const int n, const int jobs);
 
   /**
    * Root scope.
@@ -56,6 +67,49 @@ public:
   Scope* scope;
 
 private:
+  /**
+   * Parse a single file.
+   *
+   * @param file The file.
+   */
+  static void parse(File* file);
+
+  /**
+   * Apply a function to each of a list of files, distributing them across
+   * threads.
+   *
+   * @param files The files.
+   * @param f The function.
+   *
+   * If the function throws for any file, the exception of the first such
+   * file in the list is rethrown once all threads have finished.
+   */
+  void forEach(const std::list<File*>& files,
+      const std::function<void(File*)>& f);
+
+  /**
+   * Read the cache of source file hashes from a previous run.
+   *
+   * @param path Path of the cache file.
+   * @param interface Hash of the package interface for this run.
+   *
+   * @return Map from source file path to the hash of its contents. If the
+   * cache does not exist, or was written for a different package interface,
+   * the map is empty, and all source files are considered changed.
+   */
+  static std::unordered_map<std::string,std::string> readCache(
+      const fs::path& path, const std::string& interface);
+
+  /**
+   * Write the cache of source file hashes for the next run.
+   *
+   * @param path Path of the cache file.
+   * @param interface Hash of the package interface for this run.
+   * @param hashes Map from source file path to the hash of its contents.
+   */
+  void writeCache(const fs::path& path, const std::string& interface,
+      const std::unordered_map<std::string,std::string>& hashes);
+
   /**
    * Package.
    */
@@ -65,8 +119,10 @@ private:
    * Compilation unit.
    */
   std::string unit;
+
+  /**
+   * Number of threads.
+   */
+  int jobs;
 };
 }
-
-extern birch::Compiler* compiler;
-extern std::stringstream raw;
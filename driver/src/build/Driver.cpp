@@ -21,6 +21,10 @@ birch::Driver::Driver(int argc, char** argv) :
     staticLib(false),
     sharedLib(true),
     openmp(true),
+    precompileHeader(true),
+    lto(false),
+    compactPointers(false),
+    workStealing(true),
     warnings(true),
     notes(false),
     translate(true),
@@ -135,6 +139,15 @@ birch::Driver::Driver(int argc, char** argv) :
     DISABLE_SHARED_ARG,
     ENABLE_OPENMP_ARG,
     DISABLE_OPENMP_ARG,
+    ENABLE_PRECOMPILE_HEADER_ARG,
+    DISABLE_PRECOMPILE_HEADER_ARG,
+    ENABLE_LTO_ARG,
+    DISABLE_LTO_ARG,
+    ENABLE_COMPACT_POINTERS_ARG,
+    DISABLE_COMPACT_POINTERS_ARG,
+    ENABLE_WORK_STEALING_ARG,
+    DISABLE_WORK_STEALING_ARG,
+    PGO_ARG,
     JOBS_ARG,
     ENABLE_WARNINGS_ARG,
     DISABLE_WARNINGS_ARG,
@@ -165,6 +178,19 @@ birch::Driver::Driver(int argc, char** argv) :
       { "disable-shared", no_argument, 0, DISABLE_SHARED_ARG },
       { "enable-openmp", no_argument, 0, ENABLE_OPENMP_ARG },
       { "disable-openmp", no_argument, 0, DISABLE_OPENMP_ARG },
+      { "enable-precompile-header", no_argument, 0,
+          ENABLE_PRECOMPILE_HEADER_ARG },
+      { "disable-precompile-header", no_argument, 0,
+          DISABLE_PRECOMPILE_HEADER_ARG },
+      { "enable-lto", no_argument, 0, ENABLE_LTO_ARG },
+      { "disable-lto", no_argument, 0, DISABLE_LTO_ARG },
+      { "enable-compact-pointers", no_argument, 0,
+          ENABLE_COMPACT_POINTERS_ARG },
+      { "disable-compact-pointers", no_argument, 0,
+          DISABLE_COMPACT_POINTERS_ARG },
+      { "enable-work-stealing", no_argument, 0, ENABLE_WORK_STEALING_ARG },
+      { "disable-work-stealing", no_argument, 0, DISABLE_WORK_STEALING_ARG },
+      { "pgo", required_argument, 0, PGO_ARG },
       { "enable-warnings", no_argument, 0, ENABLE_WARNINGS_ARG },
       { "disable-warnings", no_argument, 0, DISABLE_WARNINGS_ARG },
       { "enable-notes", no_argument, 0, ENABLE_NOTES_ARG },
@@ -237,6 +263,33 @@ birch::Driver::Driver(int argc, char** argv) :
     case DISABLE_OPENMP_ARG:
       openmp = false;
       break;
+    case ENABLE_PRECOMPILE_HEADER_ARG:
+      precompileHeader = true;
+      break;
+    case DISABLE_PRECOMPILE_HEADER_ARG:
+      precompileHeader = false;
+      break;
+    case ENABLE_LTO_ARG:
+      lto = true;
+      break;
+    case DISABLE_LTO_ARG:
+      lto = false;
+      break;
+    case ENABLE_COMPACT_POINTERS_ARG:
+      compactPointers = true;
+      break;
+    case DISABLE_COMPACT_POINTERS_ARG:
+      compactPointers = false;
+      break;
+    case ENABLE_WORK_STEALING_ARG:
+      workStealing = true;
+      break;
+    case DISABLE_WORK_STEALING_ARG:
+      workStealing = false;
+      break;
+    case PGO_ARG:
+      pgo = optarg;
+      break;
     case ENABLE_WARNINGS_ARG:
       warnings = true;
       break;
@@ -280,8 +333,12 @@ birch::Driver::Driver(int argc, char** argv) :
   if (!arch.empty() && arch != "native") {
     throw DriverException("--arch must be native, or empty.");
   }
-  if (unit != "unity" && unit != "dir" && unit != "file") {
-    throw DriverException("--unit must be unity, dir, or file.");
+  if (unit != "unity" && unit != "dir" && unit != "file" &&
+      unit != "balanced") {
+    throw DriverException("--unit must be unity, dir, file, or balanced.");
+  }
+  if (!pgo.empty() && !release) {
+    throw DriverException("--pgo requires --enable-release.");
   }
 }
 
@@ -440,6 +497,26 @@ void birch::Driver::configure() {
     } else {
       options << " --disable-openmp";
     }
+    if (precompileHeader) {
+      options << " --enable-precompile-header";
+    } else {
+      options << " --disable-precompile-header";
+    }
+    if (lto) {
+      options << " --enable-lto";
+    } else {
+      options << " --disable-lto";
+    }
+    if (compactPointers) {
+      options << " --enable-compact-pointers";
+    } else {
+      options << " --disable-compact-pointers";
+    }
+    if (workStealing) {
+      options << " --enable-work-stealing";
+    } else {
+      options << " --disable-work-stealing";
+    }
     if (!prefix.empty()) {
       options << " --prefix=" << prefix;
     }
@@ -484,11 +561,17 @@ void birch::Driver::configure() {
 
 void birch::Driver::build() {
   configure();
+  if (!pgo.empty()) {
+    profile();
+  }
   target();
 }
 
 void birch::Driver::install() {
   configure();
+  if (!pgo.empty()) {
+    profile();
+  }
   target("install");
 }
 
@@ -574,6 +657,8 @@ void birch::Driver::clean() {
   fs::remove("lib" + tarName + ".la");
   fs::remove(tarName + ".birch");
   fs::remove(tarName + ".hpp");
+  fs::remove(tarName + ".cache");
+  fs::remove_all(tarName + ".hpp.gch");
 
   if (unit == "unity") {
     /* sources go into one *.cpp file for the whole package */
@@ -610,6 +695,22 @@ void birch::Driver::clean() {
         fs::remove(object);
       }
     }
+  } else if (unit == "balanced") {
+    /* sources go into one *.cpp file for each job */
+    auto files = birchSources();
+    for (int i = 0; i < files; ++i) {
+      fs::path source = Compiler::balanced(tarName, i, files, jobs);
+      fs::remove(source);
+      source.replace_extension(".lo");
+
+      fs::path object;
+      object = source.parent_path() / ("lib" + canonicalName + "_debug_la-" + source.filename().string());
+      fs::remove(object);
+      object = source.parent_path() / ("lib" + canonicalName + "_test_la-" + source.filename().string());
+      fs::remove(object);
+      object = source.parent_path() / ("lib" + canonicalName + "_la-" + source.filename().string());
+      fs::remove(object);
+    }
   } else {
     /* sources go into one *.cpp file for each directory */
     std::unordered_set<std::string> sources;
@@ -711,7 +812,7 @@ void birch::Driver::docs() {
   Package* package = createPackage(false);
 
   /* parse all files */
-  Compiler compiler(package, unit);
+  Compiler compiler(package, unit, jobs);
   compiler.parse(false);
 
   /* output everything into single file */
@@ -1075,6 +1176,16 @@ void birch::Driver::setup() {
         makeStream << " \\\n  " << source.string();
       }
     }
+  } else if (unit == "balanced") {
+    /* sources go into one *.cpp file for each job */
+    std::set<std::string> sources;
+    auto files = birchSources();
+    for (int i = 0; i < files; ++i) {
+      sources.insert(Compiler::balanced(tarName, i, files, jobs).string());
+    }
+    for (auto source : sources) {
+      makeStream << " \\\n  " << source;
+    }
   } else {
     /* sources go into one *.cpp file for each directory */
     std::unordered_set<std::string> sources;
@@ -1117,12 +1228,38 @@ void birch::Driver::setup() {
 }
 
 void birch::Driver::transpile() {
-  Compiler compiler(createPackage(true), unit);
+  Compiler compiler(createPackage(true), unit, jobs);
   compiler.parse(true);
   compiler.resolve();
   compiler.gen();
 }
 
+void birch::Driver::profile() {
+  /* only the release library is rebuilt, and make cannot tell that the
+   * flags have changed, so force its objects to be remade each time */
+  auto lib = "lib" + tar(packageName) + ".la";
+
+  /* instrumented build; profile updates must be atomic as programs may be
+   * multithreaded with OpenMP */
+  target("-B " + lib + " PGO_CXXFLAGS=\"-fprofile-generate "
+      "-fprofile-update=atomic\"");
+
+  /* run the workload against the release library */
+  if (verbose) {
+    std::cerr << pgo << std::endl;
+  }
+  setenv("BIRCH_MODE", "release", 1);
+  int status = std::system(pgo.c_str());
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw DriverException("workload for --pgo failed.");
+  }
+
+  /* optimized build; functions not covered by the workload have no
+   * profile, which is expected */
+  target("-B " + lib + " PGO_CXXFLAGS=\"-fprofile-use "
+      "-fprofile-correction -Wno-missing-profile\"");
+}
+
 void birch::Driver::target(const std::string& cmd) {
   /* command */
   std::stringstream buf;
@@ -1274,6 +1411,16 @@ birch::Package* birch::Driver::createPackage(bool includeRequires) {
   return package;
 }
 
+int birch::Driver::birchSources() {
+  int n = 0;
+  for (auto file : metaFiles["manifest.source"]) {
+    if (file.extension().compare(".birch") == 0) {
+      ++n;
+    }
+  }
+  return n;
+}
+
 void birch::Driver::readFiles(const std::string& key) {
   for (auto pattern : metaContents[key]) {
     auto paths = glob(pattern);
@@ -98,6 +98,13 @@ private:
    */
   void transpile();
 
+  /**
+   * Build the release library with profile-guided optimization. This builds
+   * an instrumented library, runs the workload to collect a profile, then
+   * rebuilds the library using that profile.
+   */
+  void profile();
+
   /**
    * Run make with a given target.
    *
@@ -112,6 +119,11 @@ private:
    */
   Package* createPackage(bool includeRequires);
 
+  /**
+   * Number of Birch source files in the build configuration.
+   */
+  int birchSources();
+
   /**
    * Consume a list of files from the build configuration file contents.
    *
@@ -145,7 +157,7 @@ private:
   std::string arch;
 
   /**
-   * Compilation unit (unity, dir, or file).
+   * Compilation unit (unity, dir, file, or balanced).
    */
   std::string unit;
 
@@ -185,6 +197,32 @@ private:
    */
   bool openmp;
 
+  /**
+   * Enable precompiled header?
+   */
+  bool precompileHeader;
+
+  /**
+   * Enable link-time optimization?
+   */
+  bool lto;
+
+  /**
+   * Enable single-word lazy pointers? Must match the LibBirch build.
+   */
+  bool compactPointers;
+
+  /**
+   * Schedule parallel loops by work stealing, rather than OpenMP?
+   */
+  bool workStealing;
+
+  /**
+   * Workload command for profile-guided optimization. If empty,
+   * profile-guided optimization is disabled.
+   */
+  std::string pgo;
+
   /**
    * Enable compiler warnings?
    */
@@ -5,7 +5,7 @@
 
 #include "src/visitor/all.hpp"
 
-int birch::Name::COUNTER = 0;
+std::atomic<int> birch::Name::COUNTER(0);
 
 birch::Name::Name() {
   std::stringstream buf;
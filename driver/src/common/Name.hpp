@@ -73,6 +73,6 @@ private:
   /**
    * Counter for unique names.
    */
-  static int COUNTER;
+  static std::atomic<int> COUNTER;
 };
 }
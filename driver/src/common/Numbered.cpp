@@ -3,7 +3,7 @@
  */
 #include "src/common/Numbered.hpp"
 
-int birch::Numbered::COUNTER = 0;
+std::atomic<int> birch::Numbered::COUNTER(0);
 
 birch::Numbered::Numbered() : number(++COUNTER) {
   //
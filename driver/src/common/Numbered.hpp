@@ -28,6 +28,6 @@ private:
   /**
    * Counter.
    */
-  static int COUNTER;
+  static std::atomic<int> COUNTER;
 };
 }
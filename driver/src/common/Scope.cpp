@@ -164,7 +164,9 @@ void birch::Scope::inherit(Class* o) const {
   if (base) {
     auto name = base->name->str();
     auto iter = classTypes.find(name);
-    if (iter != classTypes.end()) {
+    if (iter != classTypes.end() && o->scope->base != iter->second->scope) {
+      /* only written when changed, as the resolver may revisit a class
+       * that the baser has already handled, concurrently with lookups */
       o->scope->base = iter->second->scope;
 
       /* check for loops in inheritance */
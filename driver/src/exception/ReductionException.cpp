@@ -0,0 +1,24 @@
+/**
+ * @file
+ */
+#include "src/exception/ReductionException.hpp"
+
+#include "src/generate/BirchGenerator.hpp"
+
+birch::ReductionException::ReductionException(const Call* o) {
+  std::stringstream base;
+  BirchGenerator buf(base, 0, true);
+  if (o->loc) {
+    buf << o->loc;
+  }
+  buf << "error: reduction must be sum(x), max(x) or log_sum_exp(x), where x";
+  buf << " is a local variable of type Real or Integer, or of type Real for";
+  buf << " log_sum_exp(x).\n";
+  if (o->loc) {
+    buf << o->loc;
+  }
+  buf << "note: in\n";
+  buf << o << '\n';
+
+  msg = base.str();
+}
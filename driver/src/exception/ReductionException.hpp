@@ -0,0 +1,21 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "src/exception/Exception.hpp"
+#include "src/expression/Call.hpp"
+
+namespace birch {
+/**
+ * Invalid reduction in a parallel loop.
+ *
+ * @ingroup exception
+ */
+struct ReductionException: public Exception {
+  /**
+   * Constructor.
+   */
+  ReductionException(const Call* o);
+};
+}
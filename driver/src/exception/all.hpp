@@ -7,4 +7,5 @@
 #include "src/exception/FileNotFoundException.hpp"
 #include "src/exception/InheritanceLoopException.hpp"
 #include "src/exception/RedefinedException.hpp"
+#include "src/exception/ReductionException.hpp"
 #include "src/exception/UndefinedException.hpp"
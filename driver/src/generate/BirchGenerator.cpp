@@ -400,6 +400,9 @@ void birch::BirchGenerator::visit(const Parallel* o) {
     middle("dynamic ");
   }
   middle("parallel for " << index->name << " in " << o->from << ".." << o->to);
+  if (!o->reductions->isEmpty()) {
+    middle(" with " << o->reductions);
+  }
   finish(o->braces);
 }
 
@@ -115,6 +115,41 @@ void birch::CppClassGenerator::visit(const Class* o) {
       line("}\n");
     }
 
+    /* blank constructor, used for deserialization */
+    if (!header) {
+      genTemplateParams(o);
+      genSourceLine(o->loc);
+      start("birch::type::" << o->name);
+      genTemplateArgs(o);
+      middle("::");
+    } else {
+      genSourceLine(o->loc);
+      start("");
+    }
+    middle(o->name << "(const libbirch::Blank& blank_)");
+    if (header) {
+      finish(";\n");
+    } else {
+      finish(" :");
+      in();
+      in();
+      genSourceLine(o->loc);
+      start("super_type_(blank_)");
+      for (auto o : memberVariables) {
+        finish(',');
+        genSourceLine(o->loc);
+        start(o->name << "(libbirch::make_blank<decltype(" << o->name <<
+            ")>())");
+      }
+      out();
+      out();
+      finish(" {");
+      in();
+      line("//");
+      out();
+      line("}\n");
+    }
+
     /* member variables and functions */
     *this << o->braces->strip();
 
@@ -178,10 +213,16 @@ void birch::CppClassGenerator::visit(const MemberVariable* o) {
 void birch::CppClassGenerator::visit(const MemberFunction* o) {
   if ((generic || !o->isGeneric()) && (!o->braces->isEmpty() ||
       (header && o->has(ABSTRACT)))) {
+    /* in a final class, a member function that does not override one in a
+     * base class need not be virtual at all, while one that does may be
+     * declared final; either way, calls can be made directly */
+    auto isFinalClass = currentClass->has(FINAL);
+    auto isVirtual = o->typeParams->isEmpty() && (!isFinalClass ||
+        currentClass->scope->overrides(o->name->str()));
     if (header) {
       genTemplateParams(o);
       genSourceLine(o->loc);
-      if (o->typeParams->isEmpty()) {
+      if (isVirtual) {
         start("virtual ");
       } else {
         start("");
@@ -208,7 +249,7 @@ void birch::CppClassGenerator::visit(const MemberFunction* o) {
     }
     middle(')');
     if (header) {
-      if (o->has(FINAL) && !o->isGeneric()) {
+      if (isVirtual && (o->has(FINAL) || isFinalClass)) {
         middle(" final");
       } else if (o->has(OVERRIDE)) {
         middle(" override");
@@ -220,6 +261,7 @@ void birch::CppClassGenerator::visit(const MemberFunction* o) {
       finish(" {");
       in();
       genTraceFunction(o->name->str(), o->loc);
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       out();
       finish("}\n");
@@ -253,6 +295,7 @@ void birch::CppClassGenerator::visit(const AssignmentOperator* o) {
       in();
       genTraceFunction("<assignment>", o->loc);
       ++inOperator;
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       genSourceLine(o->loc);
       line("return *this;");
@@ -283,6 +326,7 @@ void birch::CppClassGenerator::visit(const ConversionOperator* o) {
       in();
       genTraceFunction("<conversion>", o->loc);
       ++inOperator;
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       --inOperator;
       out();
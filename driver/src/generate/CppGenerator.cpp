@@ -4,6 +4,7 @@
 #include "src/generate/CppGenerator.hpp"
 
 #include "src/generate/CppClassGenerator.hpp"
+#include "src/visitor/Gatherer.hpp"
 #include "src/primitive/string.hpp"
 
 birch::CppGenerator::CppGenerator(std::ostream& base, const int level,
@@ -18,7 +19,8 @@ birch::CppGenerator::CppGenerator(std::ostream& base, const int level,
     inLambda(0),
     inMember(0),
     inSequence(0),
-    inReturn(0) {
+    inReturn(0),
+    inHoist(0) {
   //
 }
 
@@ -51,14 +53,27 @@ void birch::CppGenerator::visit(const Literal<const char*>* o) {
 
 void birch::CppGenerator::visit(const Parentheses* o) {
   auto stripped = o->strip();
-  if (stripped->isTuple()) {
-    if (inReturn) {
-      middle("libbirch::make_tuple");
-    } else {
+  if (stripped->isTuple() && inReturn) {
+    /* elements that are local variables at their last use are moved into
+     * the tuple, rather than copied */
+    middle("libbirch::make_tuple(");
+    for (auto iter = stripped->begin(); iter != stripped->end(); ++iter) {
+      if (iter != stripped->begin()) {
+        middle(", ");
+      }
+      if (isLastUse(*iter)) {
+        middle("std::move(" << *iter << ')');
+      } else {
+        middle(*iter);
+      }
+    }
+    middle(')');
+  } else {
+    if (stripped->isTuple()) {
       middle("libbirch::tie");
     }
+    middle('(' << stripped << ')');
   }
-  middle('(' << stripped << ')');
 }
 
 void birch::CppGenerator::visit(const Sequence* o) {
@@ -110,13 +125,23 @@ void birch::CppGenerator::visit(const UnaryCall* o) {
 void birch::CppGenerator::visit(const Assign* o) {
   if (o->left->isSlice()) {
     auto slice = dynamic_cast<const Slice*>(o->left);
-    middle(slice->single << ".set");
+    ++inAssign;
+    middle(slice->single);
+    --inAssign;
+    middle(".set");
     middle("(libbirch::make_slice(" << slice->brackets << "), " << o->right << ')');
+  } else if (isInPlace(o)) {
+    /* update in place, rather than allocate a temporary for the result */
+    auto binary = dynamic_cast<const BinaryCall*>(o->right->strip());
+    ++inAssign;
+    middle(o->left);
+    --inAssign;
+    middle(' ' << binary->name->str() << "= " << binary->right);
   } else {
-    if (o->left->isMembership()) {
-      ++inAssign;
-    }
-    middle(o->left << " = " << o->right);
+    ++inAssign;
+    middle(o->left);
+    --inAssign;
+    middle(" = " << o->right);
   }
 }
 
@@ -186,22 +211,27 @@ void birch::CppGenerator::visit(const Member* o) {
       middle("this->super_type_::");
     }
   } else {
+    auto named = dynamic_cast<const NamedExpression*>(o->right);
+    assert(named);
     if (o->left->isThis()) {
-      middle("this_()->");
+      genThis(named);
+      middle("->");
     } else if (o->left->isSuper()) {
-      middle("this_()->super_type_::");
+      genThis(named);
+      middle("->super_type_::");
     } else {
-      middle(o->left);
-      auto named = dynamic_cast<const NamedExpression*>(o->right);
-      assert(named);
-      if (!inAssign && named->category == MEMBER_VARIABLE &&
-          named->type->isValue()) {
-        /* read optimization: just reading a value, no need to copy-on-write
-         * the containing object */
-        middle(".read()");
+      /* members of objects other than `this` always take the full read
+       * barrier; as the right side is MEMBER_UNKNOWN, it is not known
+       * whether the access only reads a member variable of value type, nor
+       * whether it lets the object escape */
+      middle(o->left << "->");
+      if (isExact(o->left) && named->typeArgs->isEmpty()) {
+        /* dynamic type is known, qualify the member to make any call direct;
+         * the right side is MEMBER_UNKNOWN, not known to be a function, but
+         * a qualified name is equally valid for a member variable, and finds
+         * the same member as unqualified lookup on the static type */
+        middle("std::decay_t<decltype(" << o->left << ")>::value_type::");
       }
-	    inAssign = 0;
-      middle("->");
     }
   }
   ++inMember;
@@ -245,7 +275,8 @@ void birch::CppGenerator::visit(const NamedExpression* o) {
     }
   } else if (o->isMember()) {
     if (!inMember && !inConstructor) {
-      middle("this_()->");
+      genThis(o);
+      middle("->");
     }
     middle(o->name);
   } else {
@@ -322,6 +353,7 @@ void birch::CppGenerator::visit(const Function* o) {
       finish(") {");
       in();
       genTraceFunction(o->name->str(), o->loc);
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       out();
       line("}\n");
@@ -342,6 +374,7 @@ void birch::CppGenerator::visit(const Program* o) {
       line("int birch::" << o->name << "(int argc_, char** argv_) {");
       in();
       genTraceFunction(o->name->str(), o->loc);
+      line("libbirch::install_signal_handlers();");
 
       /* handle program options */
       if (o->params->width() > 0) {
@@ -470,6 +503,7 @@ void birch::CppGenerator::visit(const Program* o) {
       line("libbirch::Lazy<libbirch::Shared<birch::type::PlayHandler>> handler_(true);\n");
 
       /* body of program */
+      gatherLocals(o->braces);
       *this << o->braces->strip();
 
       genTraceLine(o->loc);
@@ -500,6 +534,7 @@ void birch::CppGenerator::visit(const BinaryOperator* o) {
       in();
       genTraceFunction(o->name->str(), o->loc);
       ++inOperator;
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       --inOperator;
       out();
@@ -528,6 +563,7 @@ void birch::CppGenerator::visit(const UnaryOperator* o) {
       in();
       genTraceFunction(o->name->str(), o->loc);
       ++inOperator;
+      gatherLocals(o->braces);
       *this << o->braces->strip();
       --inOperator;
       out();
@@ -570,16 +606,28 @@ void birch::CppGenerator::visit(const Braces* o) {
 void birch::CppGenerator::visit(const Assume* o) {
   genTraceLine(o->loc);
   if (*o->name == "<-?") {
-    line("libbirch::optional_assign(" << o->left << ", " << o->right << ");");
+    start("libbirch::optional_assign(");
+    ++inAssign;
+    middle(o->left);
+    --inAssign;
+    finish(", " << o->right << ");");
   } else if (*o->name == "<~") {
-    start("libbirch::simulate(" << o->left << ", birch::SimulateEvent(");
-    finish('(' << o->right << ")->distribution(), handler_), handler_);");
+    start("libbirch::simulate(");
+    ++inAssign;
+    middle(o->left);
+    --inAssign;
+    middle(", ");
+    finish('(' << o->right << ")->distribution(), handler_);");
   } else if (*o->name == "~>") {
-    start("libbirch::observe(birch::ObserveEvent(" << o->left << ", ");
-    finish('(' << o->right << ")->distribution(), handler_), handler_);");
+    start("libbirch::observe(" << o->left << ", ");
+    finish('(' << o->right << ")->distribution(), handler_);");
   } else if (*o->name == "~") {
-    start("libbirch::assume(birch::AssumeEvent(" << o->left << ", ");
-    finish('(' << o->right << ")->distribution(), handler_), handler_);");
+    start("libbirch::assume(");
+    ++inAssign;
+    middle(o->left);
+    --inAssign;
+    middle(", ");
+    finish('(' << o->right << ")->distribution(), handler_);");
   } else {
     assert(false);
   }
@@ -587,8 +635,7 @@ void birch::CppGenerator::visit(const Assume* o) {
 
 void birch::CppGenerator::visit(const Factor* o) {
   genTraceLine(o->loc);
-  start("libbirch::factor(birch::FactorEvent(" << o->single);
-  finish(", handler_), handler_);");
+  line("libbirch::factor(" << o->single << ", handler_);");
 }
 
 void birch::CppGenerator::visit(const ExpressionStatement* o) {
@@ -614,54 +661,87 @@ void birch::CppGenerator::visit(const If* o) {
 void birch::CppGenerator::visit(const For* o) {
   auto index = getIndex(o->index);
   genTraceLine(o->loc);
+  auto hoisted = genHoist(o);
   start("for (auto " << index << " = " << o->from << "; ");
   finish(index << " <= " << o->to << "; ++" << index << ") {");
   in();
   *this << o->braces->strip();
   out();
   line("}");
+  if (hoisted) {
+    genUnhoist();
+  }
 }
 
 void birch::CppGenerator::visit(const Parallel* o) {
   auto index = getIndex(o->index);
   genTraceLine(o->loc);
-  line("#pragma omp parallel");
-  line("{");
-  in();
-  genTraceFunction("<parallel for>", o->loc);
-  start("#pragma omp for schedule(");
-  if (o->has(DYNAMIC)) {
-    middle("guided");
+  if (o->reductions->isEmpty()) {
+    start("libbirch::parallel_for(" << o->from << ", " << o->to << ", ");
+    middle((o->has(DYNAMIC) ? "1" : "0") << ", [&](const int64_t ");
+    middle(index);
   } else {
-    middle("static");
+    /* the lambda parameters for the partial values of the reductions shadow
+     * the variables themselves within the body */
+    std::stringstream ops, vars, params;
+    for (auto iter = o->reductions->begin(); iter != o->reductions->end();
+        ++iter) {
+      auto call = dynamic_cast<const Call*>(*iter);
+      auto op = dynamic_cast<const NamedExpression*>(call->single);
+      auto var = dynamic_cast<const NamedExpression*>(call->args);
+      assert(op && var);
+      auto name = op->name->str();
+      if (iter != o->reductions->begin()) {
+        ops << ',';
+        vars << ", ";
+      }
+      if (name == "sum") {
+        ops << "libbirch::SumReduction";
+      } else if (name == "max") {
+        ops << "libbirch::MaxReduction";
+      } else {
+        ops << "libbirch::LogSumExpReduction";
+      }
+      vars << internalise(var->name->str());
+      params << ", auto& " << internalise(var->name->str());
+    }
+    start("libbirch::parallel_reduce<" << ops.str() << ">(" << o->from);
+    middle(", " << o->to << ", " << (o->has(DYNAMIC) ? "1" : "0"));
+    middle(", std::tie(" << vars.str() << "), [&](const int64_t " << index);
+    middle(params.str());
   }
-  finish(')');
-  start("for (auto " << index << " = " << o->from << "; ");
-  finish(index << " <= " << o->to << "; ++" << index << ") {");
+  finish(") {");
   in();
+  genTraceFunction("<parallel for>", o->loc);
   *this << o->braces->strip();
   out();
-  line("}");
-  out();
-  line("}");
+  line("});");
 }
 
 void birch::CppGenerator::visit(const While* o) {
   genTraceLine(o->loc);
+  auto hoisted = genHoist(o);
   line("while (" << o->cond->strip() << ") {");
   in();
   *this << o->braces->strip();
   out();
   line("}");
+  if (hoisted) {
+    genUnhoist();
+  }
 }
 
 void birch::CppGenerator::visit(const DoWhile* o) {
   genTraceLine(o->loc);
+  auto hoisted = genHoist(o);
   line("do {");
   in();
   *this << o->braces->strip();
   out();
   line("} while (" << o->cond->strip() << ");");
+  if (hoisted) {
+    genUnhoist();
+  }
 }
 
 void birch::CppGenerator::visit(const With* o) {
@@ -680,10 +760,30 @@ void birch::CppGenerator::visit(const Assert* o) {
 }
 
 void birch::CppGenerator::visit(const Return* o) {
+  /* local variables that are used only once in a return statement are at
+   * their last use; saved and restored, as lambda functions in the return
+   * value may contain return statements of their own */
+  auto saved = lastUses;
+  lastUses.clear();
+  Gatherer<NamedExpression> locals([](const NamedExpression* o) {
+        return o->category == LOCAL_VARIABLE;
+      });
+  o->single->accept(&locals);
+  std::map<int,int> counts;
+  for (auto local : locals) {
+    ++counts[local->number];
+  }
+  for (auto count : counts) {
+    if (count.second == 1) {
+      lastUses.insert(count.first);
+    }
+  }
+
   genTraceLine(o->loc);
   ++inReturn;
   line("return " << o->single << ';');
   --inReturn;
+  lastUses = saved;
 }
 
 void birch::CppGenerator::visit(const Raw* o) {
@@ -757,6 +857,189 @@ void birch::CppGenerator::visit(const TypeList* o) {
   middle(o->head << ", " << o->tail);
 }
 
+void birch::CppGenerator::gatherLocals(const Statement* o) {
+  Gatherer<LocalVariable> objects([](const LocalVariable* o) {
+        return o->type->isClass() && o->brackets->isEmpty() &&
+            o->args->isEmpty() && o->value->isEmpty();
+      });
+  o->accept(&objects);
+
+  for (auto object : objects) {
+    auto number = object->number;
+    auto isUse = [number](const NamedExpression* o) {
+          return o->category == LOCAL_VARIABLE && o->number == number;
+        };
+
+    /* assignments that may change the dynamic type */
+    Gatherer<Assign> assigns([isUse](const Assign* o) {
+          auto left = dynamic_cast<const NamedExpression*>(o->left);
+          return left && isUse(left);
+        });
+    Gatherer<Assume> assumes([isUse](const Assume* o) {
+          auto left = dynamic_cast<const NamedExpression*>(o->left);
+          return left && isUse(left);
+        });
+    o->accept(&assigns);
+    o->accept(&assumes);
+    if (assigns.size() == 0 && assumes.size() == 0) {
+      exact.insert(number);
+    }
+  }
+}
+
+bool birch::CppGenerator::isExact(const Expression* o) const {
+  auto named = dynamic_cast<const NamedExpression*>(o);
+  return named && named->category == LOCAL_VARIABLE &&
+      exact.find(named->number) != exact.end();
+}
+
+bool birch::CppGenerator::isLastUse(const Expression* o) const {
+  auto named = dynamic_cast<const NamedExpression*>(o);
+  return named && named->category == LOCAL_VARIABLE &&
+      lastUses.find(named->number) != lastUses.end();
+}
+
+bool birch::CppGenerator::isInPlace(const Assign* o) const {
+  auto left = dynamic_cast<const NamedExpression*>(o->left);
+  auto binary = dynamic_cast<const BinaryCall*>(o->right->strip());
+  if (!left || !binary || (binary->name->str() != "+" &&
+      binary->name->str() != "-")) {
+    return false;
+  }
+  auto x = dynamic_cast<const NamedExpression*>(binary->left);
+  auto y = dynamic_cast<const NamedExpression*>(binary->right);
+  if (!x || !y || x->category != left->category ||
+      x->number != left->number) {
+    return false;
+  }
+  auto xtype = dynamic_cast<const ArrayType*>(left->type);
+  auto ytype = dynamic_cast<const ArrayType*>(y->type);
+  if (!xtype || !ytype || xtype->depth() != ytype->depth()) {
+    return false;
+  }
+  auto xelem = dynamic_cast<const NamedType*>(xtype->element());
+  auto yelem = dynamic_cast<const NamedType*>(ytype->element());
+  return xelem && yelem && xelem->name->str() == yelem->name->str() &&
+      (xelem->name->str() == "Real" || xelem->name->str() == "Integer");
+}
+
+void birch::CppGenerator::genThis(const NamedExpression* o) {
+  if (inHoist) {
+    middle("self_");
+  } else if (!inAssign && o->category == MEMBER_VARIABLE &&
+      o->type->isValue()) {
+    /* read optimization: just reading a value, no need to copy-on-write
+     * the object */
+    middle("this_pull_()");
+  } else {
+    middle("this_()");
+  }
+}
+
+bool birch::CppGenerator::genHoist(const Statement* o) {
+  if (inHoist || inConstructor) {
+    return false;
+  }
+
+  /* the right side of a member expression is categorized MEMBER_UNKNOWN,
+   * with no type, as it cannot be resolved without type deduction, so may
+   * be an object */
+  auto isObject = [](const NamedExpression* o) {
+        return o->category == MEMBER_UNKNOWN || !o->type->isValue();
+      };
+  auto hasObjects = [isObject](const Expression* o) {
+        Gatherer<NamedExpression> objects(isObject);
+        o->accept(&objects);
+        return objects.size() > 0;
+      };
+
+  /* anything that may run arbitrary code may freeze `this`; this includes
+   * operators, assignments and conversions, which may be user-defined on
+   * objects, so these are admitted only where their operands are all of
+   * value type */
+  Gatherer<Call> calls;
+  Gatherer<BinaryCall> binaries(hasObjects);
+  Gatherer<UnaryCall> unaries(hasObjects);
+  Gatherer<Assign> assigns([hasObjects](const Assign* o) {
+        return hasObjects(o->left) || hasObjects(o->right);
+      });
+  Gatherer<LambdaFunction> lambdas;
+  Gatherer<LocalVariable> locals([hasObjects](const LocalVariable* o) {
+        return !o->type->isValue() || hasObjects(o->value) ||
+            hasObjects(o->args) || hasObjects(o->brackets);
+      });
+  Gatherer<Assume> assumes;
+  Gatherer<Factor> factors;
+  Gatherer<Parallel> parallels;
+  Gatherer<With> withs;
+  Gatherer<Raw> raws;
+  o->accept(&calls);
+  o->accept(&binaries);
+  o->accept(&unaries);
+  o->accept(&assigns);
+  o->accept(&lambdas);
+  o->accept(&locals);
+  o->accept(&assumes);
+  o->accept(&factors);
+  o->accept(&parallels);
+  o->accept(&withs);
+  o->accept(&raws);
+  if (calls.size() > 0 || binaries.size() > 0 || unaries.size() > 0 ||
+      assigns.size() > 0 || lambdas.size() > 0 || locals.size() > 0 ||
+      assumes.size() > 0 || factors.size() > 0 || parallels.size() > 0 ||
+      withs.size() > 0 || raws.size() > 0) {
+    return false;
+  }
+
+  /* worth hoisting only if member variables of `this` are accessed, either
+   * by name alone or as `this.x` or `super.x` */
+  Gatherer<NamedExpression> members([](const NamedExpression* o) {
+        return o->category == MEMBER_VARIABLE;
+      });
+  Gatherer<Member> qualified([](const Member* o) {
+        return o->left->isThis() || o->left->isSuper();
+      });
+  o->accept(&members);
+  o->accept(&qualified);
+  if (members.size() == 0 && qualified.size() == 0) {
+    return false;
+  }
+
+  /* read-only if nothing is assigned through a member, and all members
+   * accessed are known to be variables of value type; a member of class
+   * type may be updated in place on access, writing to the object */
+  auto isMember = [](const NamedExpression* o) {
+        return o->isMember();
+      };
+  Gatherer<NamedExpression> unknowns([](const NamedExpression* o) {
+        return o->category == MEMBER_UNKNOWN || (o->category ==
+            MEMBER_VARIABLE && !o->type->isValue());
+      });
+  Gatherer<Assign> writes([isMember](const Assign* o) {
+        Gatherer<NamedExpression> members(isMember);
+        o->left->accept(&members);
+        return members.size() > 0;
+      });
+  o->accept(&unknowns);
+  o->accept(&writes);
+
+  line('{');
+  in();
+  if (unknowns.size() == 0 && writes.size() == 0) {
+    line("auto self_ = this_pull_();");
+  } else {
+    line("auto self_ = this_();");
+  }
+  ++inHoist;
+  return true;
+}
+
+void birch::CppGenerator::genUnhoist() {
+  --inHoist;
+  out();
+  line('}');
+}
+
 std::string birch::CppGenerator::getIndex(const Statement* o) {
   auto index = dynamic_cast<const LocalVariable*>(o);
   assert(index);
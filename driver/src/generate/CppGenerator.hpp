@@ -114,6 +114,52 @@ protected:
   template<class T>
   void genInit(const T* o);
 
+  /**
+   * Gather the local variables of a function body that are newly-constructed
+   * objects and never assigned, and so have a known dynamic type. Calls to
+   * their member functions need not be virtual.
+   */
+  void gatherLocals(const Statement* o);
+
+  /**
+   * Is an expression a local variable with a known dynamic type?
+   */
+  bool isExact(const Expression* o) const;
+
+  /**
+   * Is an expression a local variable at its last use, so that it can be
+   * moved rather than copied?
+   */
+  bool isLastUse(const Expression* o) const;
+
+  /**
+   * Can an assignment be performed in place? This is the case for `x <- x
+   * + y` and `x <- x - y`, where `x` and `y` are variables of the same
+   * numerical array type.
+   */
+  bool isInPlace(const Assign* o) const;
+
+  /**
+   * Generate the read barrier on `this` for access to a member.
+   */
+  void genThis(const NamedExpression* o);
+
+  /**
+   * Hoist the read barrier on `this` out of a loop, if possible. This is
+   * possible if the loop accesses member variables, but contains nothing
+   * that may run arbitrary code, and so may freeze `this`, such as a
+   * function call. The barrier is then taken once, into the variable
+   * `self_`, in a new scope that must be closed with genUnhoist().
+   *
+   * @return Was the barrier hoisted?
+   */
+  bool genHoist(const Statement* o);
+
+  /**
+   * Close the scope opened by genHoist().
+   */
+  void genUnhoist();
+
   /**
    * Generate the name of a loop index.
    */
@@ -185,6 +231,22 @@ protected:
    * Are we in a return statement?
    */
   int inReturn;
+
+  /**
+   * Are we in a loop with a hoisted read barrier on `this`?
+   */
+  int inHoist;
+
+  /**
+   * Numbers of local variables with a known dynamic type.
+   */
+  std::set<int> exact;
+
+  /**
+   * Numbers of local variables at their last use in the current return
+   * statement.
+   */
+  std::set<int> lastUses;
 };
 }
 
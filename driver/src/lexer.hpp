@@ -5,17 +5,70 @@
  */
 #pragma once
 
-extern FILE* yyin;
-extern char *yytext;
-extern std::stringstream raw;
-extern int yylineno;
-
-int yylex();
-int yyparse();
-void yyerror(const char *);
-void yywarn(const char *);
-void yylocation();
-void yycount();
-void yyreset();
-void yyrestart(FILE*);
-int yylex_destroy();
+namespace birch {
+class File;
+
+/**
+ * State of the lexer and parser for a single file. The lexer and parser are
+ * reentrant, keeping all of their state here, so that multiple files can be
+ * parsed concurrently, each on its own thread.
+ *
+ * @ingroup driver
+ */
+struct ParserState {
+  /**
+   * Constructor.
+   *
+   * @param file File being parsed.
+   */
+  ParserState(File* file) :
+      file(file),
+      currentLine(1),
+      currentCol(1),
+      firstLine(1),
+      firstCol(1) {
+    //
+  }
+
+  /**
+   * File being parsed.
+   */
+  File* file;
+
+  /**
+   * Raw string (documentation comment or raw C++ code) currently being
+   * accumulated by the lexer.
+   */
+  std::stringstream raw;
+
+  /**
+   * Stack of raw strings, pushed and popped by the parser.
+   */
+  std::stack<std::string> raws;
+
+  /**
+   * Current line and column of the lexer.
+   */
+  int currentLine, currentCol;
+
+  /**
+   * Line and column at the start of the most recent token, for error
+   * reporting.
+   */
+  int firstLine, firstCol;
+};
+}
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+int yylex_init_extra(birch::ParserState* state, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+void yyset_in(FILE* in, yyscan_t scanner);
+birch::ParserState* yyget_extra(yyscan_t scanner);
+int yyparse(yyscan_t scanner);
+void yyerror(birch::ParserState* state, const char* msg);
+void yywarn(birch::ParserState* state, const char* msg);
+void yylocation(birch::ParserState* state);
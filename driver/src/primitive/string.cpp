@@ -210,3 +210,14 @@ std::string birch::tar(const std::string& name) {
 std::string birch::canonical(const std::string& name) {
   return std::regex_replace(tar(name), std::regex("-"), "_");
 }
+
+std::string birch::hash(const std::string& str) {
+  uint64_t h = 14695981039346656037ull;
+  for (auto c : str) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ull;
+  }
+  std::stringstream buf;
+  buf << std::hex << std::setw(16) << std::setfill('0') << h;
+  return buf.str();
+}
@@ -96,4 +96,11 @@ std::string tar(const std::string& name);
  */
 std::string canonical(const std::string& name);
 
+/**
+ * Hash a string, for detecting changes in file contents. This is a 64-bit
+ * FNV-1a hash, formatted as 16 hexadecimal digits, and is stable across
+ * platforms and runs.
+ */
+std::string hash(const std::string& str);
+
 }
@@ -6,14 +6,16 @@
 #include "src/visitor/all.hpp"
 
 birch::Parallel::Parallel(const Annotation annotation, Statement* index,
-    Expression* from, Expression* to, Statement* braces, Location* loc) :
+    Expression* from, Expression* to, Expression* reductions,
+    Statement* braces, Location* loc) :
     Statement(loc),
     Annotated(annotation),
     Scoped(LOCAL_SCOPE),
     Braced(braces),
     index(index),
     from(from),
-    to(to) {
+    to(to),
+    reductions(reductions) {
   //
 }
 
@@ -14,6 +14,16 @@ namespace birch {
  * Parallel loop.
  *
  * @ingroup statement
+ *
+ * A parallel loop may have reductions, written as e.g.
+ * `parallel for n in 1..N with sum(x), max(y), log_sum_exp(z)`, where `x`,
+ * `y` and `z` are local variables declared before the loop. Within the body
+ * of the loop, each refers to a partial value that starts from the identity
+ * of its reduction, and that should only be updated by applying the same
+ * reduction with some other value, e.g. `x <- x + a`, `y <- max(y, b)` or
+ * `z <- log_sum_exp(z, c)`. When the loop is complete, the partial values
+ * are combined, and the result combined with the value of the variable from
+ * before the loop.
  */
 class Parallel: public Statement,
     public Annotated,
@@ -27,11 +37,13 @@ public:
    * @param index Index.
    * @param from From expression.
    * @param to To expression.
+   * @param reductions Reductions.
    * @param braces Body of loop.
    * @param loc Location.
    */
   Parallel(const Annotation annotation, Statement* index, Expression* from,
-      Expression* to, Statement* braces, Location* loc = nullptr);
+      Expression* to, Expression* reductions, Statement* braces,
+      Location* loc = nullptr);
 
   /**
    * Destructor.
@@ -56,5 +68,11 @@ public:
    * To expression.
    */
   Expression* to;
+
+  /**
+   * Reductions. Each is a Call, with the reduction as its single, and the
+   * variable as its argument.
+   */
+  Expression* reductions;
 };
 }
@@ -236,8 +236,8 @@ birch::Statement* birch::Cloner::clone(const For* o) {
 
 birch::Statement* birch::Cloner::clone(const Parallel* o) {
   return new Parallel(o->annotation, o->index->accept(this),
-      o->from->accept(this), o->to->accept(this), o->braces->accept(this),
-      o->loc);
+      o->from->accept(this), o->to->accept(this),
+      o->reductions->accept(this), o->braces->accept(this), o->loc);
 }
 
 birch::Statement* birch::Cloner::clone(const While* o) {
@@ -295,6 +295,7 @@ birch::Statement* birch::Modifier::modify(Parallel* o) {
   o->index = o->index->accept(this);
   o->from = o->from->accept(this);
   o->to = o->to->accept(this);
+  o->reductions = o->reductions->accept(this);
   o->braces = o->braces->accept(this);
   return o;
 }
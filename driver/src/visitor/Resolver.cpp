@@ -75,3 +75,33 @@ birch::Statement* birch::Resolver::modify(Class* o) {
   scopes.back()->inherit(o);
   return ScopedModifier::modify(o);
 }
+
+birch::Statement* birch::Resolver::modify(Parallel* o) {
+  ScopedModifier::modify(o);
+  for (auto iter = o->reductions->begin(); iter != o->reductions->end();
+      ++iter) {
+    auto call = dynamic_cast<const Call*>(*iter);
+    assert(call);
+    auto op = dynamic_cast<const NamedExpression*>(call->single);
+    auto var = dynamic_cast<const NamedExpression*>(call->args);
+    assert(op && var);
+    auto name = op->name->str();
+    if ((name != "sum" && name != "max" && name != "log_sum_exp") ||
+        var->category != LOCAL_VARIABLE) {
+      throw ReductionException(call);
+    }
+    if (!var->type->isEmpty()) {
+      /* the type of a variable declared with `let` is not known here, and is
+       * instead checked when the C++ is compiled, see libbirch/parallel.hpp */
+      auto type = dynamic_cast<const NamedType*>(var->type);
+      auto isReal = type && (type->name->str() == "Real" ||
+          type->name->str() == "Real64");
+      auto isInteger = type && (type->name->str() == "Integer" ||
+          type->name->str() == "Integer64");
+      if (!isReal && (!isInteger || name == "log_sum_exp")) {
+        throw ReductionException(call);
+      }
+    }
+  }
+  return o;
+}
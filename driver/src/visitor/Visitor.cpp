@@ -259,6 +259,7 @@ void birch::Visitor::visit(const Parallel* o) {
   o->index->accept(this);
   o->from->accept(this);
   o->to->accept(this);
+  o->reductions->accept(this);
   o->braces->accept(this);
 }
 
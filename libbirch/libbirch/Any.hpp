@@ -12,6 +12,9 @@
 
 namespace libbirch {
 class Label;
+class Blank;
+class Serializer;
+class Deserializer;
 
 /**
  * Base class providing reference counting, cycle breaking, and lazy deep
@@ -55,6 +58,13 @@ public:
     //
   }
 
+  /**
+   * Blank constructor.
+   */
+  Any(const Blank&) : Any() {
+    //
+  }
+
   /**
    * Copy constructor.
    */
@@ -531,6 +541,16 @@ public:
    */
   virtual void collect_() = 0;
 
+  /**
+   * Called by Serializer to write member variables.
+   */
+  virtual void serialize_(const Serializer& v) = 0;
+
+  /**
+   * Called by Deserializer to read member variables.
+   */
+  virtual void deserialize_(const Deserializer& v) = 0;
+
   /**
    * Accept a visitor across member variables.
    */
@@ -10,7 +10,6 @@
 #include "libbirch/Buffer.hpp"
 #include "libbirch/Iterator.hpp"
 #include "libbirch/Eigen.hpp"
-#include "libbirch/ReadersWriterLock.hpp"
 
 namespace libbirch {
 /**
@@ -138,8 +137,14 @@ public:
       isView(false) {
     allocate();
     int64_t n = 0;
-    for (auto iter = begin(); iter != end(); ++iter) {
-      new (&*iter) T(l(n++));
+    if (contiguous()) {
+      for (auto ptr = buf(), last = ptr + size(); ptr != last; ++ptr) {
+        new (ptr) T(l(n++));
+      }
+    } else {
+      for (auto iter = begin(); iter != end(); ++iter) {
+        new (&*iter) T(l(n++));
+      }
     }
   }
 
@@ -165,6 +170,27 @@ public:
     }
   }
 
+  /**
+   * Move constructor. A non-view gives up its buffer, with no need to
+   * update its use count. A view does not own its buffer, so is copied.
+   */
+  Array(Array<T,F>&& o) :
+      shape(o.isView ? o.shape.compact() : o.shape),
+      buffer(nullptr),
+      offset(0),
+      isView(false) {
+    if (o.isView) {
+      if (o.buffer) {
+        allocate();
+        uninitialized_copy(o);
+      }
+    } else {
+      std::swap(buffer, o.buffer);
+      std::swap(offset, o.offset);
+      o.shape = F();
+    }
+  }
+
   /**
    * Generic copy constructor.
    */
@@ -191,7 +217,6 @@ public:
    */
   void bitwiseFix() {
     assert(!isView);
-    bufferLock.bitwiseFix();
     if (buffer) {
       if (is_value<T>::value) {
         buffer->incUsage();
@@ -199,7 +224,7 @@ public:
         auto bytes = Buffer<T>::size(volume());
         assert(bytes > 0u);
 	      void* src = buf();
-        buffer = new (libbirch::allocate(bytes)) Buffer<T>();
+        buffer = new (libbirch::allocate(bytes)) Buffer<T>(volume());
         offset = 0;
         void* dst = buf();
         std::memcpy(dst, src, sizeof(T)*volume());
@@ -214,16 +239,34 @@ public:
     return assign(o);
   }
 
+  /**
+   * Move assignment operator.
+   */
+  Array<T,F>& operator=(Array<T,F>&& o) {
+    if (isView || o.isView) {
+      return assign(o);
+    } else {
+      swap(o);
+      return *this;
+    }
+  }
+
   /**
    * Accept visitor.
    */
   template<class Visitor>
   void accept_(const Visitor& v) {
     if (!is_value<T>::value) {
-      auto iter = begin();
-      auto last = end();
-      for (; iter != last; ++iter) {
-        v.visit(*iter);
+      if (contiguous()) {
+        for (auto ptr = buf(), last = ptr + size(); ptr != last; ++ptr) {
+          v.visit(*ptr);
+        }
+      } else {
+        auto iter = begin();
+        auto last = end();
+        for (; iter != last; ++iter) {
+          v.visit(*iter);
+        }
       }
     }
   }
@@ -236,16 +279,12 @@ public:
     if (isView) {
       libbirch_assert_msg_(o.shape.conforms(shape), "array sizes are different");
       copy(o);
+    } else if (o.isView) {
+      Array<T,F> tmp(o.shape, o);
+      swap(tmp);
     } else {
-      lock();
-      if (o.isView) {
-        Array<T,F> tmp(o.shape, o);
-        swap(tmp);
-      } else {
-        Array<T,F> tmp(o);
-        swap(tmp);
-      }
-      unlock();
+      Array<T,F> tmp(o);
+      swap(tmp);
     }
     return *this;
   }
@@ -257,6 +296,13 @@ public:
     return shape.size();
   }
 
+  /**
+   * Length of the @p i th dimension.
+   */
+  int64_t length(const int i) const {
+    return shape.length(i);
+  }
+
   /**
    * Number of elements allocated.
    */
@@ -265,7 +311,7 @@ public:
   }
 
   /**
-   * @name Element access, caller not responsible for thread safety
+   * @name Element access, caller not responsible for copy-on-write
    */
   ///@{
   /**
@@ -279,20 +325,17 @@ public:
    */
   template<class V, class U, std::enable_if_t<V::rangeCount() != 0,int> = 0>
   auto set(const V& slice, const U& value) {
-    pinWrite();
+    unshare();
     Array<T,decltype(shape(slice))> o(shape(slice), buffer, offset +
         shape.serial(slice));
     o = value;
-    unpin();
     return o;
   }
 
   template<class V, class U, std::enable_if_t<V::rangeCount() == 0,int> = 0>
   T& set(const V& slice, const U& value) {
-    pinWrite();
-    auto& o = (*(buf() + shape.serial(slice)) = value);
-    unpin();
-    return o;
+    unshare();
+    return *(buf() + shape.serial(slice)) = value;
   }
 
   template<class V, std::enable_if_t<V::rangeCount() != 0,int> = 0>
@@ -308,7 +351,7 @@ public:
   ///@}
 
   /**
-   * @name Element access, caller responsible for thread safety
+   * @name Element access, caller responsible for copy-on-write
    */
   ///@{
   /**
@@ -369,12 +412,11 @@ public:
    */
   template<class U, class G>
   bool operator==(const Array<U,G>& o) const {
-    pin();
-    o.pin();
-    auto result = std::equal(begin(), end(), o.begin());
-    o.unpin();
-    unpin();
-    return result;
+    if (size() > 0 && contiguous() && o.contiguous()) {
+      return std::equal(buf(), buf() + size(), o.buf());
+    } else {
+      return std::equal(begin(), end(), o.begin());
+    }
   }
   template<class U, class G>
   bool operator!=(const Array<U,G>& o) const {
@@ -382,58 +424,49 @@ public:
   }
 
   /**
-   * Pin the buffer. This prevents substitution of the buffer by
-   * copy-on-write operations until unpinned.
-   */
-  void pin() const {
-    const_cast<Array*>(this)->bufferLock.setRead();
-  }
-
-  /**
-   * As pin(), but furthermore ensures that the buffer is not shared, and
-   * thus its contents eligible for writing. If shared, a copy is performed.
-   * This is used to perform copy-on-write (if necessary) before writing the
-   * contents of the buffer.
+   * In-place addition. Code generation uses this for `x <- x + y`, which
+   * would otherwise allocate a temporary array for the result. The shapes
+   * of the two arrays must conform.
    */
-  void pinWrite() {
-    assert(!isView);
-    if (isShared()) {
-      bufferLock.setWrite();
-      if (isShared()) {
-        Array<T,F> tmp(shape, *this);
-        swap(tmp);
-      }
-      bufferLock.downgrade();
-    } else {
-      bufferLock.setRead();
-    }
-  }
-
-  /**
-   * Unpin the buffer.
-   */
-  void unpin() const {
-    const_cast<Array*>(this)->bufferLock.unsetRead();
+  template<class U, class G>
+  Array<T,F>& operator+=(const Array<U,G>& o) {
+    update(o, [](T& x, const U& y) { x += y; });
+    return *this;
   }
 
   /**
-   * Lock the buffer. This is used before substitution of the buffer by a
-   * copy-on-write operation.
+   * In-place subtraction. Code generation uses this for `x <- x - y`, which
+   * would otherwise allocate a temporary array for the result. The shapes
+   * of the two arrays must conform.
    */
-  void lock() {
-    bufferLock.setWrite();
+  template<class U, class G>
+  Array<T,F>& operator-=(const Array<U,G>& o) {
+    update(o, [](T& x, const U& y) { x -= y; });
+    return *this;
   }
 
   /**
-   * Unlock the buffer.
+   * Ensure that the buffer is not shared, and thus its contents eligible for
+   * writing. If shared, a copy is performed. This is used to perform
+   * copy-on-write (if necessary) before writing the contents of the buffer.
+   *
+   * Ownership is determined from the use count of the buffer alone. Arrays
+   * that share a buffer may be written concurrently by different threads,
+   * as each copies before writing and releases the original only once done.
+   * The same array must not be written by one thread while it is read or
+   * written by another, just as for any other variable.
    */
-  void unlock() {
-    bufferLock.unsetWrite();
+  void unshare() {
+    assert(!isView);
+    if (isShared()) {
+      Array<T,F> tmp(shape, *this);
+      swap(tmp);
+    }
   }
   ///@}
 
   /**
-   * @name Thread-safe resize
+   * @name Resize
    */
   ///@{
   /**
@@ -442,27 +475,24 @@ public:
    *
    * @param i Position.
    * @param x Value.
+   *
+   * The buffer grows geometrically, so that repeated insertion at the back
+   * takes amortized constant time. Insertion at the front reuses any space
+   * left there by erase().
    */
   void insert(const int64_t i, const T& x) {
     static_assert(F::count() == 1, "can only enlarge one-dimensional arrays");
     assert(!isView);
 
-    lock();
     auto n = size();
-    auto s = F(n + 1);
-    if (!buffer || isShared()) {
-      Array<T,F> tmp(s, *this);
-      swap(tmp);
+    if (i == 0 && offset > 0 && !isShared()) {
+      --offset;
     } else {
-      auto oldBytes = Buffer<T>::size(shape.volume());
-      auto newBytes = Buffer<T>::size(s.volume());
-      buffer = (Buffer<T>*)libbirch::reallocate(buffer, oldBytes,
-          buffer->tid, newBytes);
+      reserve(n + 1);
+      std::memmove((void*)(buf() + i + 1), (void*)(buf() + i), (n - i)*sizeof(T));
     }
-    std::memmove((void*)(buf() + i + 1), (void*)(buf() + i), (n - i)*sizeof(T));
     new (buf() + i) T(x);
-    shape = s;
-    unlock();
+    shape = F(n + 1);
   }
 
   /**
@@ -471,6 +501,11 @@ public:
    *
    * @param i Position.
    * @param len Number of elements to erase.
+   *
+   * Erasing from the front leaves space there, rather than moving the
+   * remaining elements, so that repeated erasure from the front takes
+   * constant time. The buffer shrinks when less than a quarter of it is in
+   * use.
    */
   void erase(const int64_t i, const int64_t len = 1) {
     static_assert(F::count() == 1, "can only shrink one-dimensional arrays");
@@ -478,7 +513,6 @@ public:
     assert(len > 0);
     assert(size() >= len);
 
-    lock();
     auto n = size();
     auto s = F(n - len);
     if (s.size() == 0) {
@@ -488,17 +522,19 @@ public:
         Array<T,F> tmp(shape, *this);
         swap(tmp);
       }
-      for (int j = i; j < i + len; ++j) {
+      for (int64_t j = i; j < i + len; ++j) {
         buf()[j].~T();
       }
-      std::memmove((void*)(buf() + i), (void*)(buf() + i + len), (n - len - i)*sizeof(T));
-      auto oldBytes = Buffer<T>::size(shape.volume());
-      auto newBytes = Buffer<T>::size(s.volume());
-      buffer = (Buffer<T>*)libbirch::reallocate(buffer, oldBytes,
-          buffer->tid, newBytes);
+      if (i == 0) {
+        offset += len;
+      } else {
+        std::memmove((void*)(buf() + i), (void*)(buf() + i + len), (n - len - i)*sizeof(T));
+      }
+      if (4*s.volume() < buffer->capacity) {
+        resize(s.volume(), buffer->capacity/2);
+      }
     }
     shape = s;
-    unlock();
   }
   ///@}
 
@@ -596,6 +632,29 @@ public:
   ///@}
 
 private:
+  /**
+   * Update each element in place from the corresponding element of another
+   * array.
+   */
+  template<class U, class G, class Op>
+  void update(const Array<U,G>& o, Op op) {
+    libbirch_assert_msg_(o.shape.conforms(shape), "array sizes are different");
+    if (!isView) {
+      unshare();
+    }
+    if (size() > 0 && contiguous() && o.contiguous()) {
+      auto src = o.buf();
+      for (auto dst = buf(), last = dst + size(); dst != last; ++dst, ++src) {
+        op(*dst, *src);
+      }
+    } else {
+      auto src = o.begin();
+      for (auto dst = begin(), last = end(); dst != last; ++dst, ++src) {
+        op(*dst, *src);
+      }
+    }
+  }
+
   /**
    * Constructor for forced copy.
    */
@@ -609,6 +668,19 @@ private:
     uninitialized_copy(o);
   }
 
+  /**
+   * Constructor for forced copy, with room for @p capacity elements.
+   */
+  template<class U, class G>
+  Array(const F& shape, const Array<U,G>& o, const int64_t capacity) :
+      shape(shape.compact()),
+      buffer(nullptr),
+      offset(0),
+      isView(false) {
+    allocate(capacity);
+    uninitialized_copy(o);
+  }
+
   /**
    * Constructor for views.
    */
@@ -649,12 +721,59 @@ private:
    * Allocate memory for array, leaving uninitialized.
    */
   void allocate() {
+    allocate(volume());
+  }
+
+  /**
+   * Allocate memory for array with room for @p capacity elements, leaving
+   * uninitialized.
+   */
+  void allocate(const int64_t capacity) {
     assert(!buffer);
-    auto bytes = Buffer<T>::size(volume());
+    assert(capacity >= volume());
+    auto bytes = Buffer<T>::size(capacity);
     if (bytes > 0u) {
-      buffer = new (libbirch::allocate(bytes)) Buffer<T>();
+      buffer = new (libbirch::allocate(bytes)) Buffer<T>(capacity);
+      offset = 0;
+    }
+  }
+
+  /**
+   * For a one-dimensional array, ensure that the buffer is not shared and
+   * has room for @p n elements from the current offset. Capacity at least
+   * doubles each time that it grows.
+   */
+  void reserve(const int64_t n) {
+    if (!buffer || isShared()) {
+      Array<T,F> tmp(shape, *this, std::max(n, 2*size()));
+      swap(tmp);
+    } else if (offset + n > buffer->capacity) {
+      auto capacity = buffer->capacity;
+      resize(size(), 2*n > capacity ? std::max(n, 2*capacity) : capacity);
+    }
+  }
+
+  /**
+   * For a one-dimensional array, move the first @p n elements to the start
+   * of the buffer and reallocate it with room for @p capacity elements.
+   */
+  void resize(const int64_t n, const int64_t capacity) {
+    assert(!isShared());
+    assert(n <= capacity);
+    if (offset > 0) {
+      std::memmove((void*)buffer->buf(), (void*)buf(), n*sizeof(T));
       offset = 0;
     }
+    if (capacity != buffer->capacity) {
+      auto oldBytes = Buffer<T>::size(buffer->capacity);
+      auto newBytes = Buffer<T>::size(capacity);
+      auto ptr = libbirch::reallocate(buffer, oldBytes, buffer->tid, newBytes);
+      if (ptr != buffer) {
+        buffer = (Buffer<T>*)ptr;
+        buffer->tid = get_thread_num();
+      }
+      buffer->capacity = capacity;
+    }
   }
 
   /**
@@ -664,19 +783,56 @@ private:
     if (!isView && buffer && buffer->decUsage() == 0u) {
       if (!is_value<T>::value) {
         ///@todo in C++17 can use std::destroy()
-        auto iter = begin();
-        auto last = end();
-        for (; iter != last; ++iter) {
-          iter->~T();
+        if (contiguous()) {
+          for (auto ptr = buf(), last = ptr + size(); ptr != last; ++ptr) {
+            ptr->~T();
+          }
+        } else {
+          auto iter = begin();
+          auto last = end();
+          for (; iter != last; ++iter) {
+            iter->~T();
+          }
         }
       }
-      size_t bytes = Buffer<T>::size(volume());
+      size_t bytes = Buffer<T>::size(buffer->capacity);
       libbirch::deallocate(buffer, bytes, buffer->tid);
     }
     buffer = nullptr;
     offset = 0;
   }
 
+  /**
+   * Is storage contiguous? Contiguous arrays iterate over a raw pointer
+   * rather than computing the offset of each element from its serial
+   * number, which the compiler can vectorize.
+   */
+  bool contiguous() const {
+    return shape.contiguous();
+  }
+
+  /**
+   * Are rows contiguous? For a matrix, this is the case when elements are
+   * adjacent within each row, even if rows are not adjacent, as for a view
+   * of a block of columns.
+   */
+  bool rowContiguous() const {
+    return F::count() == 2 && shape.rowContiguous();
+  }
+
+  /**
+   * Can elements be copied from another array row by row? Rows must be
+   * contiguous in both, and the two must have the same number of rows and
+   * columns; arrays of the same size but a different shape do not match row
+   * for row.
+   */
+  template<class U>
+  bool rowConforms(const U& o) const {
+    return rowContiguous() && o.rowContiguous() &&
+        shape.length(0) == o.shape.length(0) &&
+        shape.length(1) == o.shape.length(1);
+  }
+
   /**
    * Initialize allocated memory.
    *
@@ -684,10 +840,16 @@ private:
    */
   template<class ... Args>
   void initialize(Args ... args) {
-    auto iter = begin();
-    auto last = end();
-    for (; iter != last; ++iter) {
-      new (&*iter) T(args...);
+    if (contiguous()) {
+      for (auto ptr = buf(), last = ptr + size(); ptr != last; ++ptr) {
+        new (ptr) T(args...);
+      }
+    } else {
+      auto iter = begin();
+      auto last = end();
+      for (; iter != last; ++iter) {
+        new (&*iter) T(args...);
+      }
     }
   }
 
@@ -697,14 +859,24 @@ private:
   template<class U>
   void copy(const U& o) {
     auto n = std::min(size(), o.size());
-    auto begin1 = o.begin();
-    auto end1 = begin1 + n;
-    auto begin2 = begin();
-    auto end2 = begin2 + n;
-    if (inside(begin1, end1, begin2)) {
-      std::copy_backward(begin1, end1, end2);
+    if (n > 0 && contiguous() && o.contiguous()) {
+      copy_n(o.buf(), n, buf());
+    } else if (n > 0 && rowConforms(o) && !aliases(o)) {
+      auto rows = shape.length(0);
+      auto cols = shape.length(1);
+      for (int64_t i = 0; i < rows; ++i) {
+        copy_n(o.buf() + i*o.shape.stride(0), cols, buf() + i*shape.stride(0));
+      }
     } else {
-      std::copy(begin1, end1, begin2);
+      auto begin1 = o.begin();
+      auto end1 = begin1 + n;
+      auto begin2 = begin();
+      auto end2 = begin2 + n;
+      if (inside(begin1, end1, begin2)) {
+        std::copy_backward(begin1, end1, end2);
+      } else {
+        std::copy(begin1, end1, begin2);
+      }
     }
   }
 
@@ -715,14 +887,66 @@ private:
   void uninitialized_copy(const U& o) {
     assert(!isShared());
     auto n = std::min(size(), o.size());
-    auto begin1 = o.begin();
-    auto end1 = begin1 + n;
-    auto begin2 = begin();
-    for (; begin1 != end1; ++begin1, ++begin2) {
-      new (&*begin2) T(*begin1);
+    if (n > 0 && contiguous() && o.contiguous()) {
+      uninitialized_copy_n(o.buf(), n, buf());
+    } else if (n > 0 && rowConforms(o)) {
+      auto rows = shape.length(0);
+      auto cols = shape.length(1);
+      for (int64_t i = 0; i < rows; ++i) {
+        uninitialized_copy_n(o.buf() + i*o.shape.stride(0), cols,
+            buf() + i*shape.stride(0));
+      }
+    } else {
+      auto begin1 = o.begin();
+      auto end1 = begin1 + n;
+      auto begin2 = begin();
+      for (; begin1 != end1; ++begin1, ++begin2) {
+        new (&*begin2) T(*begin1);
+      }
     }
   }
 
+  /**
+   * Does this array share a buffer with another?
+   */
+  template<class U>
+  bool aliases(const U& o) const {
+    return (void*)buffer == (void*)o.buffer;
+  }
+
+  /**
+   * Assign @p n contiguous elements, where the source and destination may
+   * overlap.
+   */
+  static void copy_n(const T* src, const int64_t n, T* dst) {
+    if (std::is_trivially_copyable<T>::value) {
+      std::memmove((void*)dst, (const void*)src, n*sizeof(T));
+    } else if (src < dst && dst < src + n) {
+      std::copy_backward(src, src + n, dst + n);
+    } else {
+      std::copy(src, src + n, dst);
+    }
+  }
+  template<class U>
+  static void copy_n(const U* src, const int64_t n, T* dst) {
+    std::copy(src, src + n, dst);
+  }
+
+  /**
+   * Copy @p n contiguous elements into uninitialized memory.
+   */
+  static void uninitialized_copy_n(const T* src, const int64_t n, T* dst) {
+    if (std::is_trivially_copyable<T>::value) {
+      std::memcpy((void*)dst, (const void*)src, n*sizeof(T));
+    } else {
+      std::uninitialized_copy(src, src + n, dst);
+    }
+  }
+  template<class U>
+  static void uninitialized_copy_n(const U* src, const int64_t n, T* dst) {
+    std::uninitialized_copy(src, src + n, dst);
+  }
+
   /**
    * Shape.
    */
@@ -734,7 +958,8 @@ private:
   Buffer<T>* buffer;
 
   /**
-   * Offset into the buffer. This should be zero when isView is false.
+   * Offset into the buffer. When isView is false, this is nonzero only for
+   * a one-dimensional array that has had elements erased from the front.
    */
   int64_t offset;
 
@@ -743,13 +968,6 @@ private:
    * semantics, as it cannot be resized or moved.
    */
   bool isView;
-
-  /**
-   * Lock used for copy-on-write. Read use is obtained when the current
-   * buffer must be preserved for either read or write operations. Write use
-   * is obtained to substitute the current buffer with another.
-   */
-  ReadersWriterLock bufferLock;
 };
 
 template<class T, class F>
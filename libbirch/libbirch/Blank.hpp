@@ -0,0 +1,62 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "libbirch/Tuple.hpp"
+#include "libbirch/Optional.hpp"
+#include "libbirch/Lazy.hpp"
+
+namespace libbirch {
+/**
+ * Tag type for the blank constructor of a class. The blank constructor
+ * initializes each member variable to a blank value (see make_blank()),
+ * allocating no further objects, in preparation for the member variables to
+ * be overwritten, as by Deserializer.
+ *
+ * @ingroup libbirch
+ */
+class Blank {
+  //
+};
+
+/**
+ * Blank value of a type.
+ *
+ * @tparam T Type.
+ */
+template<class T>
+struct blank {
+  static T make() {
+    return T();
+  }
+};
+
+template<class P>
+struct blank<Lazy<P>> {
+  static Lazy<P> make() {
+    return Lazy<P>(nullptr);
+  }
+};
+
+template<class Head, class... Tail>
+struct blank<Tuple<Head,Tail...>> {
+  static Tuple<Head,Tail...> make() {
+    return Tuple<Head,Tail...>(blank<Head>::make(), blank<Tail>::make()...);
+  }
+};
+
+/**
+ * Make a blank value. For a pointer this is null, rather than a newly
+ * allocated object as for default construction.
+ *
+ * @ingroup libbirch
+ *
+ * @tparam T Type.
+ */
+template<class T>
+T make_blank() {
+  return blank<T>::make();
+}
+
+}
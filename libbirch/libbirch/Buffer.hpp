@@ -27,8 +27,10 @@ public:
 
   /**
    * Constructor.
+   *
+   * @param capacity Number of elements allocated.
    */
-  Buffer();
+  Buffer(const int64_t capacity);
 
   /**
    * Increment the usage count.
@@ -63,6 +65,12 @@ public:
    */
   static size_t size(const int64_t n);
 
+  /**
+   * Number of elements allocated. This may exceed the number of elements in
+   * use by the arrays sharing the buffer, to allow them to grow.
+   */
+  int64_t capacity;
+
   /**
    * Id of the thread that allocated the buffer.
    */
@@ -83,7 +91,8 @@ private:
 }
 
 template<class T>
-libbirch::Buffer<T>::Buffer() :
+libbirch::Buffer<T>::Buffer(const int64_t capacity) :
+    capacity(capacity),
     tid(get_thread_num()),
     useCount(1) {
   //
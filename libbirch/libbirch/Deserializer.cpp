@@ -0,0 +1,25 @@
+/**
+ * @file
+ */
+#include "libbirch/Deserializer.hpp"
+
+/**
+ * Registered classes, by name.
+ */
+static std::unordered_map<std::string,libbirch::blank_factory*>& classes() {
+  static std::unordered_map<std::string,libbirch::blank_factory*> classes;
+  return classes;
+}
+
+void libbirch::register_class(const char* name, blank_factory* f) {
+  classes()[name] = f;
+}
+
+libbirch::blank_factory* libbirch::find_class(const std::string& name) {
+  auto iter = classes().find(name);
+  if (iter != classes().end()) {
+    return iter->second;
+  } else {
+    return nullptr;
+  }
+}
@@ -0,0 +1,317 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "libbirch/external.hpp"
+#include "libbirch/assert.hpp"
+#include "libbirch/Tuple.hpp"
+#include "libbirch/Array.hpp"
+#include "libbirch/Optional.hpp"
+#include "libbirch/Lazy.hpp"
+#include "libbirch/Blank.hpp"
+
+namespace libbirch {
+/**
+ * Function that constructs an object of a particular class with its blank
+ * constructor.
+ */
+using blank_factory = Any*();
+
+/**
+ * Register a class for deserialization.
+ *
+ * @ingroup libbirch
+ *
+ * @param name Name of the class, as given by `typeid`.
+ * @param f Function to construct a blank object of the class.
+ */
+void register_class(const char* name, blank_factory* f);
+
+/**
+ * Find a registered class.
+ *
+ * @ingroup libbirch
+ *
+ * @param name Name of the class, as given by `typeid`.
+ *
+ * @return Function to construct a blank object of the class, or null if the
+ * class is not registered.
+ */
+blank_factory* find_class(const std::string& name);
+
+/**
+ * Registers a class for deserialization on program start. The boilerplate
+ * code for each (non-abstract) class refers to `instance`, which is then
+ * constructed during static initialization, for a class template, once for
+ * each instantiation of it.
+ *
+ * @ingroup libbirch
+ *
+ * @tparam T Class type.
+ */
+template<class T>
+class Registrar {
+public:
+  Registrar() {
+    register_class(typeid(T).name(), &make);
+  }
+
+  static Any* make() {
+    return new T(Blank());
+  }
+
+  static Registrar<T> instance;
+};
+
+template<class T>
+Registrar<T> Registrar<T>::instance;
+
+/**
+ * Visitor for reading objects written by Serializer.
+ *
+ * @ingroup libbirch
+ *
+ * Each object is constructed with its blank constructor, then its member
+ * variables read in place. Objects are read into the root label.
+ */
+class Deserializer {
+public:
+  /**
+   * Constructor.
+   *
+   * @param in Input stream.
+   */
+  Deserializer(std::istream& in) :
+      in(in) {
+    //
+  }
+
+  /**
+   * Read an object, and all objects reachable from it.
+   *
+   * @param o Pointer to which to assign the object.
+   */
+  template<class P>
+  void read(Lazy<P>& o) {
+    visit(o);
+    while (!pending.empty()) {
+      auto ptr = pending.front();
+      pending.pop_front();
+      ptr->deserialize_(*this);
+    }
+  }
+
+  /**
+   * Visit list of variables.
+   *
+   * @param arg First variable.
+   * @param args... Remaining variables.
+   */
+  template<class Arg, class... Args>
+  void visit(Arg& arg, Args&... args) const {
+    visit(arg);
+    visit(args...);
+  }
+
+  /**
+   * Visit empty list of variables (base case).
+   */
+  void visit() const {
+    //
+  }
+
+  /**
+   * Visit an arithmetic value.
+   */
+  template<class T, std::enable_if_t<std::is_arithmetic<T>::value,int> = 0>
+  void visit(T& arg) const {
+    readBytes(&arg, sizeof(T));
+  }
+
+  /**
+   * Visit a string.
+   */
+  void visit(std::string& o) const {
+    int64_t length;
+    visit(length);
+    libbirch_error_msg_(length >= 0, "invalid input for deserialization");
+    o.resize(length);
+    readBytes(&o[0], length);
+  }
+
+  /**
+   * Visit any other value, which is not supported.
+   */
+  template<class T, std::enable_if_t<!std::is_arithmetic<T>::value,int> = 0>
+  void visit(T& arg) const {
+    libbirch_error_msg_(false, "cannot deserialize a value of type " <<
+        typeid(T).name());
+  }
+
+  /**
+   * Visit a tuple.
+   */
+  template<class Head, class... Tail>
+  void visit(Tuple<Head,Tail...>& o) const {
+    o.accept_(*this);
+  }
+
+  /**
+   * Visit an array.
+   */
+  template<class T, class F>
+  void visit(Array<T,F>& o) const {
+    auto shape = readShape(static_cast<F*>(nullptr));
+    auto l = [this](const int64_t n) {
+      T x = make_blank<T>();
+      visit(x);
+      return x;
+    };
+    o = Array<T,F>(l, shape);
+  }
+
+  /**
+   * Visit an optional.
+   */
+  template<class T>
+  void visit(Optional<T>& o) const {
+    bool hasValue;
+    visit(hasValue);
+    if (hasValue) {
+      T x = make_blank<T>();
+      visit(x);
+      o = Optional<T>(std::move(x));
+    } else {
+      o = Optional<T>();
+    }
+  }
+
+  /**
+   * Visit a lazy pointer.
+   */
+  template<class P>
+  void visit(Lazy<P>& o) const {
+    auto ptr = readPointer();
+    if (ptr) {
+      auto cast = dynamic_cast<typename P::value_type*>(ptr);
+      libbirch_error_msg_(cast, "deserialized object of class " <<
+          ptr->getClassName() << " has incorrect type");
+      o = Lazy<P>(cast, root());
+    } else {
+      o = Lazy<P>(nullptr);
+    }
+  }
+
+  /**
+   * Visit a Cholesky factorization.
+   */
+  template<class M>
+  void visit(Eigen::LLT<M>& o) const {
+    int64_t n;
+    visit(n);
+    if (n > 0) {
+      M A(n, n);
+      for (int64_t i = 0; i < n; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+          visit(A(i, j));
+        }
+      }
+      o.compute(A);
+    } else {
+      o = Eigen::LLT<M>();
+    }
+  }
+
+private:
+  /**
+   * Read bytes.
+   */
+  void readBytes(void* data, const int64_t n) const {
+    in.read(static_cast<char*>(data), n);
+    libbirch_error_msg_(in, "unexpected end of input for deserialization");
+  }
+
+  /**
+   * Read a shape.
+   */
+  EmptyShape readShape(EmptyShape*) const {
+    return EmptyShape();
+  }
+
+  /**
+   * Read a shape.
+   */
+  template<class Head, class Tail>
+  Shape<Head,Tail> readShape(Shape<Head,Tail>*) const {
+    int64_t length;
+    visit(length);
+    libbirch_error_msg_(length >= 0, "invalid input for deserialization");
+    auto tail = readShape(static_cast<Tail*>(nullptr));
+    return Shape<Head,Tail>(Head(length, tail.volume()), tail);
+  }
+
+  /**
+   * Read a pointer; see Serializer.
+   */
+  Any* readPointer() const {
+    int64_t id;
+    visit(id);
+    if (id == 0) {
+      return nullptr;
+    } else if (id <= int64_t(objects.size())) {
+      return objects[id - 1];
+    } else {
+      libbirch_error_msg_(id == int64_t(objects.size() + 1),
+          "invalid input for deserialization");
+      auto ptr = readClass()();
+      objects.push_back(ptr);
+      pending.push_back(ptr);
+      return ptr;
+    }
+  }
+
+  /**
+   * Read a class; see Serializer.
+   *
+   * @return Function to construct a blank object of the class.
+   */
+  blank_factory* readClass() const {
+    int64_t id;
+    visit(id);
+    if (0 < id && id <= int64_t(classes.size())) {
+      return classes[id - 1];
+    } else {
+      libbirch_error_msg_(id == int64_t(classes.size() + 1),
+          "invalid input for deserialization");
+      std::string name;
+      visit(name);
+      auto f = find_class(name);
+      libbirch_error_msg_(f, "cannot deserialize an object of class " <<
+          name << ", it is not registered");
+      classes.push_back(f);
+      return f;
+    }
+  }
+
+  /**
+   * Input stream.
+   */
+  std::istream& in;
+
+  /**
+   * Objects read so far, indexed by id less one.
+   */
+  mutable std::vector<Any*> objects;
+
+  /**
+   * Classes read so far, indexed by id less one.
+   */
+  mutable std::vector<blank_factory*> classes;
+
+  /**
+   * Objects read, with member variables yet to be read.
+   */
+  mutable std::deque<Any*> pending;
+};
+}
@@ -5,6 +5,7 @@
 
 #include "libbirch/Any.hpp"
 #include "libbirch/type.hpp"
+#include "libbirch/pack.hpp"
 
 namespace libbirch {
 /**
@@ -44,6 +45,23 @@ public:
    * Copy constructor.
    */
   Init(const Init& o) :
+      ptr(o.get()) {
+    //
+  }
+
+  /**
+   * Move constructor.
+   */
+  Init(Init&& o) :
+      ptr(o.ptr.load()) {
+    //
+  }
+
+  /**
+   * Generic move constructor.
+   */
+  template<class U, std::enable_if_t<std::is_base_of<T,U>::value,int> = 0>
+  Init(Init<U>&& o) :
       ptr(o.ptr.load()) {
     //
   }
@@ -52,6 +70,23 @@ public:
    * Copy assignment.
    */
   Init& operator=(const Init& o) {
+    ptr.store(o.get());
+    return *this;
+  }
+
+  /**
+   * Move assignment.
+   */
+  Init& operator=(Init&& o) {
+    ptr.store(o.ptr.load());
+    return *this;
+  }
+
+  /**
+   * Generic move assignment.
+   */
+  template<class U, std::enable_if_t<std::is_base_of<T,U>::value,int> = 0>
+  Init& operator=(Init<U>&& o) {
     ptr.store(o.ptr.load());
     return *this;
   }
@@ -70,21 +105,21 @@ public:
    * conversion operators in the referent type.
    */
   bool query() const {
-    return ptr.load() != nullptr;
+    return get() != nullptr;
   }
 
   /**
    * Get the raw pointer.
    */
   T* get() const {
-    return ptr.load();
+    return unpack(ptr.load());
   }
 
   /**
    * Replace.
    */
   void replace(T* ptr) {
-    this->ptr.store(ptr);
+    replace(ptr, packed(this->ptr.load()));
   }
 
   /**
@@ -138,7 +173,32 @@ public:
 
 private:
   /**
-   * Raw pointer.
+   * Constructor with packed bits.
+   */
+  Init(value_type* ptr, const uintptr_t bits) :
+      ptr(pack(ptr, bits)) {
+    //
+  }
+
+  /**
+   * Replace, with packed bits.
+   */
+  void replace(T* ptr, const uintptr_t bits) {
+    this->ptr.store(pack(ptr, bits));
+  }
+
+  /**
+   * Get the packed bits.
+   */
+  uintptr_t bits() const {
+    return packed(ptr.load());
+  }
+
+  /**
+   * Raw pointer. When used within Lazy, this may have bits packed into it
+   * (see LIBBIRCH_COMPACT_POINTERS). The copy constructor and assignment
+   * operator do not propagate these, but the move constructor and
+   * assignment operator do.
    */
   Atomic<T*> ptr;
 };
@@ -3,7 +3,74 @@
  */
 #include "libbirch/Label.hpp"
 
-libbirch::Label::Label() : Any(0) {
+#include "libbirch/Lock.hpp"
+
+#if LIBBIRCH_COMPACT_POINTERS
+libbirch::Label* libbirch::labels[MAX_LABELS];
+
+/**
+ * Lock for assigning label ids.
+ */
+static libbirch::Lock& label_lock() {
+  static libbirch::Lock lock;
+  return lock;
+}
+
+/**
+ * Ids of destroyed labels, available for reuse.
+ */
+static std::vector<unsigned>& free_label_ids() {
+  static std::vector<unsigned> ids;
+  return ids;
+}
+
+/**
+ * Next id never assigned to a label. Id zero is reserved for no label.
+ */
+static unsigned next_label_id = 1u;
+#endif
+
+/**
+ * Assign an id to a new label. Labels may be created during static
+ * initialization (e.g. the root label), hence the function-local statics
+ * above.
+ */
+static unsigned register_label(libbirch::Label* label) {
+  #if LIBBIRCH_COMPACT_POINTERS
+  unsigned id;
+  label_lock().set();
+  auto& ids = free_label_ids();
+  if (!ids.empty()) {
+    id = ids.back();
+    ids.pop_back();
+  } else {
+    id = next_label_id++;
+  }
+  label_lock().unset();
+  libbirch_error_msg_(id < libbirch::MAX_LABELS, "too many labels for " <<
+      "compact pointers, reconfigure with --disable-compact-pointers");
+  libbirch::labels[id] = label;
+  return id;
+  #else
+  return 0u;
+  #endif
+}
+
+/**
+ * Release the id of a destroyed label.
+ */
+static void deregister_label(const unsigned id) {
+  #if LIBBIRCH_COMPACT_POINTERS
+  libbirch::labels[id] = nullptr;
+  label_lock().set();
+  free_label_ids().push_back(id);
+  label_lock().unset();
+  #endif
+}
+
+libbirch::Label::Label() :
+    Any(0),
+    id(register_label(this)) {
   //
 }
 
@@ -17,6 +84,10 @@ libbirch::Label::Label(const Label& o) :
   o1.lock.unsetRead();
 }
 
+libbirch::Label::~Label() {
+  deregister_label(id);
+}
+
 libbirch::Any* libbirch::Label::mapGet(Any* o) {
   Any* prev = nullptr;
   Any* next = o;
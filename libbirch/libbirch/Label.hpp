@@ -5,6 +5,7 @@
 
 #include "libbirch/Any.hpp"
 #include "libbirch/Memo.hpp"
+#include "libbirch/pack.hpp"
 
 namespace libbirch {
 /**
@@ -24,6 +25,18 @@ public:
    */
   Label(const Label& o);
 
+  /**
+   * Destructor.
+   */
+  virtual ~Label();
+
+  /**
+   * Id of the label, used to pack it into the spare bits of object pointers
+   * when LIBBIRCH_COMPACT_POINTERS is enabled. Zero if LibBirch was built
+   * with it disabled.
+   */
+  const unsigned id;
+
   /**
    * Update a smart pointer for writing.
    *
@@ -81,6 +94,21 @@ public:
     return ptr;
   }
 
+  /**
+   * Map a raw pointer for reading.
+   *
+   * @param ptr Raw pointer.
+   */
+  template<class T>
+  auto pull(T* ptr)  {
+    if (ptr && ptr->isFrozen()) {  // isFrozen a useful guard for performance
+      lock.setRead();
+      ptr = static_cast<T*>(mapPull(ptr));
+      lock.unsetRead();
+    }
+    return ptr;
+  }
+
   /**
    * Map a raw pointer for reading, with no locking.
    *
@@ -183,6 +211,14 @@ public:
     memo.collect();
   }
 
+  virtual void serialize_(const libbirch::Serializer& v) override {
+    //
+  }
+
+  virtual void deserialize_(const libbirch::Deserializer& v) override {
+    //
+  }
+
   using base_type = Any;
 };
 
@@ -190,4 +226,29 @@ template<unsigned N>
 struct is_acyclic_class<Label,N> {
   static const bool value = false;
 };
+
+#if LIBBIRCH_COMPACT_POINTERS
+/**
+ * Labels by id.
+ */
+extern Label* labels[MAX_LABELS];
+
+/**
+ * Convert a label into bits for packing into an object pointer.
+ *
+ * @ingroup libbirch
+ */
+inline uintptr_t pack_label(Label* label) {
+  return label ? pack_label_id(label->id) : 0u;
+}
+
+/**
+ * Convert bits packed into an object pointer into a label.
+ *
+ * @ingroup libbirch
+ */
+inline Label* label_of(const uintptr_t bits) {
+  return labels[unpack_label_id(bits)];
+}
+#endif
 }
@@ -10,6 +10,7 @@
 #include "libbirch/Init.hpp"
 #include "libbirch/Label.hpp"
 #include "libbirch/LabelPtr.hpp"
+#include "libbirch/pack.hpp"
 
 namespace libbirch {
 /**
@@ -18,6 +19,12 @@ namespace libbirch {
  * @ingroup libbirch
  *
  * @tparam P Pointer type, e.g. Shared or Init.
+ *
+ * Each pointer has an associated label. By default the label is stored in
+ * a second word alongside the object pointer. If LIBBIRCH_COMPACT_POINTERS
+ * is enabled, the id of the label is instead packed into the spare bits of
+ * the object pointer, so that the whole occupies a single word, and the
+ * object and label are read together with a single atomic load.
  */
 template<class P>
 class Lazy {
@@ -38,8 +45,7 @@ public:
    * Constructor.
    */
   Lazy(value_type* ptr, Label* label = nullptr) :
-      object(ptr),
-      label(label ? label : ptr->Any::getLabel()) {
+      Lazy(ptr, label ? label : ptr->Any::getLabel(), 0) {
     //
   }
 
@@ -51,8 +57,7 @@ public:
    * it by calling its default constructor.
    */
   Lazy() :
-      object(new value_type()),
-      label(root()) {
+      Lazy(new value_type(), root(), 0) {
     static_assert(std::is_default_constructible<value_type>::value,
         "invalid call to class constructor");
     // ^ ideally this condition would be checked with SFINAE, but the
@@ -77,8 +82,7 @@ public:
   template<class Arg, std::enable_if_t<!std::is_base_of<value_type,
       typename raw<Arg>::type>::value,int> = 0>
   explicit Lazy(const Arg& arg) :
-      object(new value_type(arg)),
-      label(root()) {
+      Lazy(new value_type(arg), root(), 0) {
     //
   }
 
@@ -99,8 +103,7 @@ public:
    */
   template<class Arg1, class Arg2, class... Args>
   explicit Lazy(const Arg1& arg1, const Arg2& arg2, const Args&... args) :
-      object(new value_type(arg1, arg2, args...)),
-      label(root()) {
+      Lazy(new value_type(arg1, arg2, args...), root(), 0) {
     //
   }
 
@@ -108,8 +111,7 @@ public:
    * Copy constructor.
    */
   Lazy(const Lazy& o) :
-      object(o.get()),
-      label(o.label) {
+      Lazy(o.get(), o.getLabel(), 0) {
     // ^ o.get() maintains the single-reference optimization
   }
 
@@ -119,8 +121,7 @@ public:
   template<class Q, std::enable_if_t<std::is_base_of<value_type,
       typename Q::value_type>::value,int> = 0>
   Lazy(const Lazy<Q>& o) :
-      object(o.get()),
-      label(o.label) {
+      Lazy(static_cast<value_type*>(o.get()), o.getLabel(), 0) {
     // ^ o.get() maintains the single-reference optimization
   }
 
@@ -135,8 +136,12 @@ public:
   template<class Q, std::enable_if_t<std::is_base_of<value_type,
       typename Q::value_type>::value,int> = 0>
   Lazy(Lazy<Q>&& o) :
+      #if LIBBIRCH_COMPACT_POINTERS
+      object(std::move(o.object)) {
+      #else
       object(std::move(o.object)),
       label(std::move(o.label)) {
+      #endif
     //
   }
 
@@ -151,8 +156,13 @@ public:
    * Correctly initialize after a bitwise copy.
    */
   void bitwiseFix(Label* newLabel) {
+    #if LIBBIRCH_COMPACT_POINTERS
+    new (&object) pointer_type(newLabel->pullNoLock(object.get()),
+        pack_label(newLabel));  // overwrite with new label
+    #else
     new (&object) pointer_type(newLabel->pullNoLock(object.get()));
     new (&label) label_type(newLabel);  // overwrite with new label
+    #endif
   }
 
   /**
@@ -177,9 +187,15 @@ public:
    * Copy assignment.
    */
   Lazy& operator=(const Lazy& o) {
+    #if LIBBIRCH_COMPACT_POINTERS
+    auto bits = pack_label(o.getLabel());
+    // ^ must go first, next line may invalidate o as a reference
+    object.replace(o.get(), bits);
+    #else
     label = o.label;
     // ^ must go first, next line may invalidate o as a reference
     object.replace(o.get());
+    #endif
     // ^ o.get() maintains the single-reference optimization
     return *this;
   }
@@ -190,9 +206,15 @@ public:
   template<class Q, std::enable_if_t<std::is_base_of<value_type,
       typename Q::value_type>::value,int> = 0>
   Lazy& operator=(const Lazy<Q>& o) {
+    #if LIBBIRCH_COMPACT_POINTERS
+    auto bits = pack_label(o.getLabel());
+    // ^ must go first, next line may invalidate o as a reference
+    object.replace(o.get(), bits);
+    #else
     label = o.label;
     // ^ must go first, next line may invalidate o as a reference
     object.replace(o.get());
+    #endif
     // ^ o.get() maintains the single-reference optimization
     return *this;
   }
@@ -201,8 +223,10 @@ public:
    * Move assignment.
    */
   Lazy& operator=(Lazy&& o) {
+    #if !LIBBIRCH_COMPACT_POINTERS
     label = std::move(o.label);
     // ^ must go first, next line may invalidate o as a reference
+    #endif
     object = std::move(o.object);
     // ^ std::move() maintains the single-reference optimization
     return *this;
@@ -214,8 +238,10 @@ public:
   template<class Q, std::enable_if_t<std::is_base_of<value_type,
       typename Q::value_type>::value,int> = 0>
   Lazy& operator=(Lazy<Q>&& o) {
+    #if !LIBBIRCH_COMPACT_POINTERS
     label = std::move(o.label);
     // ^ must go first, next line may invalidate o as a reference
+    #endif
     object = std::move(o.object);
     // ^ std::move() maintains the single-reference optimization
     return *this;
@@ -232,7 +258,7 @@ public:
    * Get the raw pointer, with lazy cloning.
    */
   value_type* get() {
-    auto label = this->label.get();  // ensures only single read of atomic
+    auto label = getLabel();  // ensures only single read of atomic
     if (label) {
       return label->get(object);
     } else {
@@ -252,7 +278,7 @@ public:
    * Get the raw pointer for read-only use, without cloning.
    */
   value_type* pull() {
-    auto label = this->label.get();  // ensures only single read of atomic
+    auto label = getLabel();  // ensures only single read of atomic
     if (label) {
       return label->pull(object);
     } else {
@@ -268,6 +294,16 @@ public:
     return const_cast<Lazy*>(this)->pull();
   }
 
+  /**
+   * Get the raw pointer as stored, without mapping it through the label.
+   * This is for visitors that apply a label of their own, as for a member
+   * variable of a frozen object, which is to be viewed through the label
+   * with which that object was reached.
+   */
+  value_type* peek() const {
+    return object.get();
+  }
+
   /**
    * Dereference.
    */
@@ -288,14 +324,22 @@ public:
    * Get the label associated with the pointer.
    */
   Label* getLabel() const {
+    #if LIBBIRCH_COMPACT_POINTERS
+    return label_of(object.bits());
+    #else
     return label.get();
+    #endif
   }
 
   /**
    * Set the label associated with the pointer.
    */
   void setLabel(Label* label) {
+    #if LIBBIRCH_COMPACT_POINTERS
+    object.replace(object.get(), pack_label(label));
+    #else
     this->label.replace(label);
+    #endif
   }
 
   /**
@@ -324,7 +368,9 @@ public:
    */
   void mark() {
     object.mark();
+    #if !LIBBIRCH_COMPACT_POINTERS
     label.mark();
+    #endif
   }
 
   /**
@@ -332,7 +378,9 @@ public:
    */
   void scan() {
     object.scan();
+    #if !LIBBIRCH_COMPACT_POINTERS
     label.scan();
+    #endif
   }
 
   /**
@@ -340,7 +388,9 @@ public:
    */
   void reach() {
     object.reach();
+    #if !LIBBIRCH_COMPACT_POINTERS
     label.reach();
+    #endif
   }
 
   /**
@@ -348,19 +398,36 @@ public:
    */
   void collect() {
     object.collect();
+    #if !LIBBIRCH_COMPACT_POINTERS
     label.collect();
+    #endif
   }
 
 private:
+  /**
+   * Constructor, where both the object and label may be null.
+   */
+  Lazy(value_type* ptr, Label* label, int) :
+      #if LIBBIRCH_COMPACT_POINTERS
+      object(ptr, pack_label(label)) {
+      #else
+      object(ptr),
+      label(label) {
+      #endif
+    //
+  }
+
   /**
    * Object.
    */
   pointer_type object;
 
+  #if !LIBBIRCH_COMPACT_POINTERS
   /**
    * Label.
    */
   label_type label;
+  #endif
 };
 
 template<class P>
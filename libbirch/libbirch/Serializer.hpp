@@ -0,0 +1,253 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "libbirch/external.hpp"
+#include "libbirch/assert.hpp"
+#include "libbirch/Tuple.hpp"
+#include "libbirch/Array.hpp"
+#include "libbirch/Optional.hpp"
+#include "libbirch/Lazy.hpp"
+
+namespace libbirch {
+/**
+ * Visitor for writing an object, and all objects reachable from it, in
+ * binary form.
+ *
+ * @ingroup libbirch
+ *
+ * Each object is written once, however many pointers there are to it, so
+ * that sharing and cycles are preserved when read back with Deserializer.
+ * Objects are written in breadth-first order from a worklist, rather than
+ * recursively, so that long chains of objects do not exhaust the stack.
+ *
+ * Pointers are followed as for reading, with pull(), so that writing does not
+ * trigger any lazy copies; instead, objects that are yet to be copied are
+ * written as they would be if copied. Values are written in native byte order, so the
+ * output is intended to be read back by the same program on the same
+ * platform, as for a checkpoint.
+ *
+ * Member variables of arithmetic, string, array, optional, tuple, pointer
+ * and LLT type are supported. It is an error to write a member variable of
+ * another type, such as a function or file.
+ */
+class Serializer {
+public:
+  /**
+   * Constructor.
+   *
+   * @param out Output stream.
+   */
+  Serializer(std::ostream& out) :
+      out(out) {
+    //
+  }
+
+  /**
+   * Write an object, and all objects reachable from it.
+   *
+   * @param o Pointer to the object.
+   */
+  template<class P>
+  void write(const Lazy<P>& o) {
+    visit(const_cast<Lazy<P>&>(o));
+    while (!pending.empty()) {
+      auto next = pending.front();
+      pending.pop_front();
+      context = next.second;
+      next.first->serialize_(*this);
+    }
+  }
+
+  /**
+   * Visit list of variables.
+   *
+   * @param arg First variable.
+   * @param args... Remaining variables.
+   */
+  template<class Arg, class... Args>
+  void visit(Arg& arg, Args&... args) const {
+    visit(arg);
+    visit(args...);
+  }
+
+  /**
+   * Visit empty list of variables (base case).
+   */
+  void visit() const {
+    //
+  }
+
+  /**
+   * Visit an arithmetic value.
+   */
+  template<class T, std::enable_if_t<std::is_arithmetic<T>::value,int> = 0>
+  void visit(T& arg) const {
+    out.write(reinterpret_cast<const char*>(&arg), sizeof(T));
+  }
+
+  /**
+   * Visit a string.
+   */
+  void visit(std::string& o) const {
+    int64_t length = o.length();
+    visit(length);
+    out.write(o.data(), length);
+  }
+
+  /**
+   * Visit any other value, which is not supported.
+   */
+  template<class T, std::enable_if_t<!std::is_arithmetic<T>::value,int> = 0>
+  void visit(T& arg) const {
+    libbirch_error_msg_(false, "cannot serialize a value of type " <<
+        typeid(T).name());
+  }
+
+  /**
+   * Visit a tuple.
+   */
+  template<class Head, class... Tail>
+  void visit(Tuple<Head,Tail...>& o) const {
+    o.accept_(*this);
+  }
+
+  /**
+   * Visit an array. The length of each dimension is written, then the
+   * elements in row-major order.
+   */
+  template<class T, class F>
+  void visit(Array<T,F>& o) const {
+    for (int i = 0; i < F::count(); ++i) {
+      int64_t length = o.length(i);
+      visit(length);
+    }
+    const auto& a = o;  // const iterators do not require exclusive buffer
+    for (auto iter = a.begin(), last = a.end(); iter != last; ++iter) {
+      visit(*iter);
+    }
+  }
+
+  /**
+   * Visit an optional.
+   */
+  template<class T>
+  void visit(Optional<T>& o) const {
+    bool hasValue = o.query();
+    visit(hasValue);
+    if (hasValue) {
+      visit(o.get());
+    }
+  }
+
+  /**
+   * Visit a lazy pointer.
+   */
+  template<class P>
+  void visit(Lazy<P>& o) const {
+    Any* ptr = o.peek();
+    Label* label = nullptr;
+    if (ptr) {
+      label = context ? context : o.getLabel();
+      ptr = label->pull(ptr);
+    }
+    writePointer(ptr, label);
+  }
+
+  /**
+   * Visit a Cholesky factorization. The original matrix is written, to be
+   * factorized again when read.
+   */
+  template<class M>
+  void visit(Eigen::LLT<M>& o) const {
+    int64_t n = o.rows();
+    visit(n);
+    if (n > 0) {
+      M A = o.reconstructedMatrix();
+      for (int64_t i = 0; i < n; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+          visit(A(i, j));
+        }
+      }
+    }
+  }
+
+private:
+  /**
+   * Write a pointer. An object is identified by the order in which it is
+   * first reached, from one, with zero for null. On first reaching an
+   * object, its class is written too, and it is added to the worklist for
+   * its member variables to be written after those of all objects reached
+   * before it.
+   *
+   * A frozen object may be shared between lazy copies, and is a different
+   * object as viewed through each of their labels, so is identified by the
+   * label too, and its member variables viewed through that label in turn.
+   */
+  void writePointer(Any* ptr, Label* label) const {
+    int64_t id = 0;
+    if (ptr) {
+      auto key = std::make_pair(ptr, ptr->isFrozen() ? label : nullptr);
+      auto result = ids.insert(std::make_pair(key, int64_t(ids.size() + 1)));
+      id = result.first->second;
+      visit(id);
+      if (result.second) {
+        writeClass(typeid(*ptr).name());
+        pending.push_back(key);
+      }
+    } else {
+      visit(id);
+    }
+  }
+
+  /**
+   * Write a class. As for objects, a class is identified by the order in
+   * which it is first reached, with its name written then too.
+   */
+  void writeClass(std::string name) const {
+    auto result = classes.insert(std::make_pair(name,
+        int64_t(classes.size() + 1)));
+    int64_t id = result.first->second;
+    visit(id);
+    if (result.second) {
+      visit(name);
+    }
+  }
+
+  /**
+   * Hash for keys of objects.
+   */
+  struct key_hash {
+    size_t operator()(const std::pair<Any*,Label*>& o) const {
+      return std::hash<Any*>()(o.first) ^ std::hash<Label*>()(o.second);
+    }
+  };
+
+  /**
+   * Output stream.
+   */
+  std::ostream& out;
+
+  /**
+   * Ids of objects reached so far.
+   */
+  mutable std::unordered_map<std::pair<Any*,Label*>,int64_t,key_hash> ids;
+
+  /**
+   * Ids of classes reached so far.
+   */
+  mutable std::unordered_map<std::string,int64_t> classes;
+
+  /**
+   * Objects reached, with member variables yet to be written.
+   */
+  mutable std::deque<std::pair<Any*,Label*>> pending;
+
+  /**
+   * Label through which to view the member variables currently being
+   * written, if the object is frozen, otherwise null.
+   */
+  Label* context = nullptr;
+};
+}
@@ -58,6 +58,14 @@ struct EmptyShape {
     return 0;
   }
 
+  static constexpr bool contiguous() {
+    return true;
+  }
+
+  static constexpr bool rowContiguous() {
+    return true;
+  }
+
   int64_t length(const int i) const {
     assert(false);
     return 0;
@@ -208,6 +216,23 @@ struct Shape {
     }
   }
 
+  /**
+   * Is storage contiguous? This is the case when elements that are adjacent
+   * in storage order are also adjacent in memory, i.e. the shape is compact.
+   */
+  bool contiguous() const {
+    return head.stride == tail.size() && tail.contiguous();
+  }
+
+  /**
+   * Is storage contiguous within the leading dimension? For a matrix, this
+   * is the case when the elements of each row are adjacent in memory, even
+   * if the rows themselves are not, as for a block of columns.
+   */
+  bool rowContiguous() const {
+    return tail.contiguous();
+  }
+
   /**
    * @name Getters
    */
@@ -6,6 +6,7 @@
 #include "libbirch/Any.hpp"
 #include "libbirch/Atomic.hpp"
 #include "libbirch/type.hpp"
+#include "libbirch/pack.hpp"
 
 namespace libbirch {
 /**
@@ -27,17 +28,15 @@ public:
    * Constructor.
    */
   explicit Shared(value_type* ptr = nullptr) :
-      ptr(ptr) {
-    if (ptr) {
-      ptr->incShared();
-    }
+      Shared(ptr, 0u) {
+    //
   }
 
   /**
    * Copy constructor.
    */
   Shared(const Shared& o) {
-    auto ptr = o.ptr.load();
+    auto ptr = o.get();
     if (ptr) {
       ptr->incShared();
     }
@@ -49,7 +48,7 @@ public:
    */
   template<class U, std::enable_if_t<std::is_base_of<T,U>::value,int> = 0>
   Shared(const Shared<U>& o) {
-    auto ptr = o.ptr.load();
+    auto ptr = o.get();
     if (ptr) {
       ptr->incShared();
     }
@@ -61,7 +60,7 @@ public:
    */
   template<class Q, std::enable_if_t<std::is_base_of<T,typename Q::value_type>::value,int> = 0>
   Shared(const Q& o) {
-    auto ptr = o.ptr.load();
+    auto ptr = o.get();
     if (ptr) {
       ptr->incShared();
     }
@@ -94,7 +93,7 @@ public:
    * Fix after a bitwise copy.
    */
   void bitwiseFix() {
-    auto ptr = this->ptr.get();
+    auto ptr = get();
     if (ptr) {
       ptr->incShared();
     }
@@ -131,9 +130,9 @@ public:
    */
   Shared& operator=(Shared&& o) {
     auto ptr = o.ptr.exchange(nullptr);
-    auto old = this->ptr.exchange(ptr);
+    auto old = unpack(this->ptr.exchange(ptr));
     if (old) {
-      if (ptr == old) {
+      if (unpack(ptr) == old) {
         old->decSharedReachable();
       } else if (is_acyclic<Shared<T>>::value) {
         old->decSharedAcyclic();
@@ -150,9 +149,9 @@ public:
   template<class U, std::enable_if_t<std::is_base_of<T,U>::value,int> = 0>
   Shared& operator=(Shared<U>&& o) {
     auto ptr = o.ptr.exchange(nullptr);
-    auto old = this->ptr.exchange(ptr);
+    auto old = unpack(this->ptr.exchange(ptr));
     if (old) {
-      if (ptr == old) {
+      if (unpack(ptr) == old) {
         old->decSharedReachable();
       } else if (is_acyclic<Shared<T>>::value) {
         old->decSharedAcyclic();
@@ -170,40 +169,28 @@ public:
    * conversion operators in the referent type.
    */
   bool query() const {
-    return ptr.load() != nullptr;
+    return get() != nullptr;
   }
 
   /**
    * Get the raw pointer.
    */
   T* get() const {
-    return ptr.load();
+    return unpack(ptr.load());
   }
 
   /**
    * Replace.
    */
   void replace(T* ptr) {
-    if (ptr) {
-      ptr->incShared();
-    }
-    auto old = this->ptr.exchange(ptr);
-    if (old) {
-      if (ptr == old) {
-        old->decSharedReachable();
-      } else if (is_acyclic<Shared<T>>::value) {
-        old->decSharedAcyclic();
-      } else {
-        old->decShared();
-      }
-    }
+    replace(ptr, packed(this->ptr.load()));
   }
 
   /**
    * Release.
    */
   void release() {
-    auto old = ptr.exchange(nullptr);
+    auto old = unpack(ptr.exchange(nullptr));
     if (old) {
       if (is_acyclic<Shared<T>>::value) {
         old->decSharedAcyclic();
@@ -232,7 +219,7 @@ public:
    */
   void mark() {
     if (!is_acyclic<Shared<T>>::value) {
-      auto o = ptr.load();
+      auto o = get();
       if (o) {
         o->decSharedReachable();  // break the reference
         o->Any::mark();
@@ -245,7 +232,7 @@ public:
    */
   void scan() {
     if (!is_acyclic<Shared<T>>::value) {
-      auto o = ptr.load();
+      auto o = get();
       if (o) {
         o->Any::scan();
       }
@@ -257,7 +244,7 @@ public:
    */
   void reach() {
     if (!is_acyclic<Shared<T>>::value) {
-      auto o = ptr.load();
+      auto o = get();
       if (o) {
         o->incShared();  // restore the broken reference
         o->Any::reach();
@@ -270,7 +257,8 @@ public:
    */
   void collect() {
     if (!is_acyclic<Shared<T>>::value) {
-      auto o = ptr.exchange(nullptr);  // reference still broken, just set null
+      auto o = unpack(ptr.exchange(nullptr));
+      // ^ reference still broken, just set null
       if (o) {
         o->Any::collect();
       }
@@ -279,7 +267,45 @@ public:
 
 private:
   /**
-   * Raw pointer.
+   * Constructor with packed bits.
+   */
+  Shared(value_type* ptr, const uintptr_t bits) :
+      ptr(pack(ptr, bits)) {
+    if (ptr) {
+      ptr->incShared();
+    }
+  }
+
+  /**
+   * Replace, with packed bits.
+   */
+  void replace(T* ptr, const uintptr_t bits) {
+    if (ptr) {
+      ptr->incShared();
+    }
+    auto old = unpack(this->ptr.exchange(pack(ptr, bits)));
+    if (old) {
+      if (ptr == old) {
+        old->decSharedReachable();
+      } else if (is_acyclic<Shared<T>>::value) {
+        old->decSharedAcyclic();
+      } else {
+        old->decShared();
+      }
+    }
+  }
+
+  /**
+   * Get the packed bits.
+   */
+  uintptr_t bits() const {
+    return packed(ptr.load());
+  }
+
+  /**
+   * Raw pointer. When used within Lazy, this may have bits packed into it
+   * (see LIBBIRCH_COMPACT_POINTERS). The copy constructors do not propagate
+   * these, but the move constructors do.
    */
   Atomic<T*> ptr;
 };
@@ -34,7 +34,7 @@ public:
    */
   template<class... Tail1>
   Tuple(Head head, Tail1&&... tail) :
-      head(head),
+      head(std::forward<Head>(head)),
       tail(std::forward<Tail1>(tail)...) {
     //
   }
@@ -308,7 +308,8 @@ struct is_acyclic<Tuple<>,N> {
 template<class Head, class... Tail>
 auto make_tuple(Head&& head, Tail&&... tail) {
   return Tuple<typename std::decay<Head>::type,
-      typename std::decay<Tail>::type...>(head, std::forward<Tail>(tail)...);
+      typename std::decay<Tail>::type...>(std::forward<Head>(head),
+      std::forward<Tail>(tail)...);
 }
 
 /**
@@ -320,7 +321,7 @@ auto make_tuple(Head&& head, Tail&&... tail) {
  */
 template<class Head>
 auto make_tuple(Head&& head) {
-  return Tuple<typename std::decay<Head>::type>(head);
+  return Tuple<typename std::decay<Head>::type>(std::forward<Head>(head));
 }
 
 /**
@@ -64,6 +64,15 @@
   \
   virtual void collect_() override { \
     this->accept_(libbirch::Collector()); \
+  } \
+  \
+  virtual void serialize_(const libbirch::Serializer& v_) override { \
+    this->accept_(v_); \
+  } \
+  \
+  virtual void deserialize_(const libbirch::Deserializer& v_) override { \
+    (void)libbirch::Registrar<Name>::instance; \
+    this->accept_(v_); \
   }
 
 /**
@@ -99,6 +108,10 @@
     return this->getLabel()->get(this); \
   } \
   \
+  auto this_pull_() { \
+    return this->getLabel()->pull(this); \
+  } \
+  \
   auto shared_from_this_() { \
     return libbirch::Lazy<libbirch::Shared<Name>>(this); \
   } \
@@ -119,6 +132,10 @@
     return this->getLabel()->get(this); \
   } \
   \
+  auto this_pull_() { \
+    return this->getLabel()->pull(this); \
+  } \
+  \
   auto shared_from_this_() { \
     return libbirch::Lazy<libbirch::Shared<Name>>(this); \
   } \
@@ -160,3 +177,5 @@
 #include "libbirch/Scanner.hpp"
 #include "libbirch/Reacher.hpp"
 #include "libbirch/Collector.hpp"
+#include "libbirch/Serializer.hpp"
+#include "libbirch/Deserializer.hpp"
@@ -11,16 +11,20 @@
 #include <utility>
 #include <functional>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include <memory>
 #include <string>
 #include <sstream>
 #include <iomanip>
 #include <initializer_list>
+#include <typeinfo>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <cmath>
 #include <unistd.h>
 #include <getopt.h>
@@ -10,6 +10,7 @@
 #include "libbirch/assert.hpp"
 #include "libbirch/thread.hpp"
 #include "libbirch/memory.hpp"
+#include "libbirch/parallel.hpp"
 #include "libbirch/stacktrace.hpp"
 #include "libbirch/class.hpp"
 #include "libbirch/type.hpp"
@@ -377,13 +378,16 @@ auto optional_assign(const To& to, const Optional<From>& from) {
  * Simulate. Corresponds to the `<~` operator in Birch.
  *
  * @param left Target.
- * @param event Event.
+ * @param p Distribution.
  * @param handler Event handler.
+ *
+ * The event is handled by the handleSimulate() member function of the
+ * handler, which is non-virtual, and only constructs an event object if the
+ * handler has an input or output trace. No virtual call is made to get there.
  */
-template<class Left, class Event, class Handler>
-auto simulate(Left& left, const Event& event, const Handler& handler) {
-  handler->handle(event);
-  left = event->value();
+template<class Left, class Distribution, class Handler>
+auto simulate(Left& left, const Distribution& p, const Handler& handler) {
+  left = handler->handleSimulate(p);
   return left;
 }
 
@@ -391,47 +395,48 @@ auto simulate(Left& left, const Event& event, const Handler& handler) {
  * Simulate. Corresponds to the `<~` operator in Birch.
  *
  * @param left Target.
- * @param event Event.
+ * @param p Distribution.
  * @param handler Event handler.
  */
-template<class Left, class Event, class Handler>
-auto simulate(Left&& left, const Event& event, const Handler& handler) {
-  handler->handle(event);
-  left = event->value();
+template<class Left, class Distribution, class Handler>
+auto simulate(Left&& left, const Distribution& p, const Handler& handler) {
+  left = handler->handleSimulate(p);
   return left;
 }
 
 /**
- * Observe. Corresponds to the `<~` operator in Birch.
+ * Observe. Corresponds to the `~>` operator in Birch.
  *
- * @param event Event.
+ * @param x Observed value.
+ * @param p Distribution.
  * @param handler Event handler.
  */
-template<class Event, class Handler>
-void observe(const Event& event, const Handler& handler) {
-  handler->handle(event);
+template<class Value, class Distribution, class Handler>
+void observe(const Value& x, const Distribution& p, const Handler& handler) {
+  handler->handleObserve(x, p);
 }
 
 /**
  * Assume. Corresponds to the `~` operator in Birch.
  *
- * @param event Event.
+ * @param x Random variate.
+ * @param p Distribution.
  * @param handler Event handler.
  */
-template<class Event, class Handler>
-void assume(const Event& event, const Handler& handler) {
-  handler->handle(event);
+template<class Random, class Distribution, class Handler>
+void assume(const Random& x, const Distribution& p, const Handler& handler) {
+  handler->handleAssume(x, p);
 }
 
 /**
  * Factor. Corresponds to the `factor` statement in Birch.
  *
- * @param event Event.
+ * @param w Weight.
  * @param handler Event handler.
  */
-template<class Event, class Handler>
-void factor(const Event& event, const Handler& handler) {
-  handler->handle(event);
+template<class Weight, class Handler>
+void factor(const Weight& w, const Handler& handler) {
+  handler->handleFactor(w);
 }
 
 }
@@ -197,6 +197,13 @@ void libbirch::register_unreachable(Any* o) {
 }
 
 void libbirch::collect() {
+  #ifdef _OPENMP
+  if (omp_in_parallel()) {
+    /* other threads may be mutating the object graph; defer to the next
+     * call from outside a parallel region */
+    return;
+  }
+  #endif
   #pragma omp parallel num_threads(get_max_threads())
   {
     /* mark */
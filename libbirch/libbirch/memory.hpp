@@ -77,6 +77,11 @@ void register_unreachable(Any* o);
 
 /**
  * Run the cycle collector.
+ *
+ * When called from within a parallel region, such as the body of a parallel
+ * loop, this does nothing, as other threads may be modifying the objects it
+ * would traverse; the possible roots registered in the meantime are retained
+ * until the next call from outside a parallel region.
  */
 void collect();
 
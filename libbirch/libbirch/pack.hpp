@@ -0,0 +1,110 @@
+/**
+ * @file
+ *
+ * Packing of labels into the spare bits of object pointers.
+ */
+#pragma once
+
+#include "libbirch/external.hpp"
+#include "libbirch/assert.hpp"
+
+/**
+ * @def LIBBIRCH_COMPACT_POINTERS
+ *
+ * Set to true for Lazy pointers to occupy a single word, with the id of
+ * their label packed into the spare bits of the object pointer, or false for
+ * them to occupy two words, one for the object pointer and one for the label
+ * pointer.
+ *
+ * This is set with `--enable-compact-pointers` when configuring both
+ * LibBirch and packages; all must agree on the setting.
+ */
+#ifndef LIBBIRCH_COMPACT_POINTERS
+#define LIBBIRCH_COMPACT_POINTERS 0
+#endif
+
+#if LIBBIRCH_COMPACT_POINTERS
+static_assert(sizeof(void*) == 8u && sizeof(uintptr_t) == 8u,
+    "compact pointers require a platform with 64-bit pointers");
+#endif
+
+namespace libbirch {
+/**
+ * Bits of an object pointer that are available to pack a label id: the high
+ * 16 bits, which are unused by user-space addresses on 64-bit platforms, and
+ * the low 4 bits, which are zero as objects are aligned to at least 16
+ * bytes. When compact pointers are disabled, no bits are used, and masking
+ * with this compiles away.
+ *
+ * @ingroup libbirch
+ */
+static constexpr uintptr_t LABEL_BITS = LIBBIRCH_COMPACT_POINTERS ?
+    0xFFFF00000000000Full : 0ull;
+
+/**
+ * Maximum number of labels that can exist at any one time when compact
+ * pointers are enabled. Id zero is reserved for no label.
+ *
+ * @ingroup libbirch
+ */
+static constexpr unsigned MAX_LABELS = 1u << 20u;
+
+/**
+ * Strip any packed bits from an object pointer.
+ *
+ * @ingroup libbirch
+ */
+template<class T>
+T* unpack(T* ptr) {
+  return (T*)((uintptr_t)ptr & ~LABEL_BITS);
+}
+
+/**
+ * Get the packed bits of an object pointer.
+ *
+ * @ingroup libbirch
+ */
+template<class T>
+uintptr_t packed(T* ptr) {
+  return (uintptr_t)ptr & LABEL_BITS;
+}
+
+/**
+ * Pack bits into an object pointer. The pointer must not already have any
+ * packed bits.
+ *
+ * This also checks that the address itself does not use them, in release
+ * builds too: a platform may place objects above 48 bits (e.g. with
+ * five-level paging) or misaligned, which would otherwise corrupt the
+ * pointer silently. When compact pointers are disabled, the check compiles
+ * away.
+ *
+ * @ingroup libbirch
+ */
+template<class T>
+T* pack(T* ptr, const uintptr_t bits) {
+  libbirch_error_msg_(packed(ptr) == 0u, "object address " << (void*)ptr <<
+      " does not fit compact pointers, reconfigure with " <<
+      "--disable-compact-pointers");
+  return (T*)((uintptr_t)ptr | (bits & LABEL_BITS));
+}
+
+/**
+ * Convert a label id into bits for packing into an object pointer.
+ *
+ * @ingroup libbirch
+ */
+inline uintptr_t pack_label_id(const unsigned id) {
+  assert(id < MAX_LABELS);
+  return (uintptr_t(id) & 0xFull) | (uintptr_t(id >> 4u) << 48u);
+}
+
+/**
+ * Convert bits packed into an object pointer into a label id.
+ *
+ * @ingroup libbirch
+ */
+inline unsigned unpack_label_id(const uintptr_t bits) {
+  return unsigned(bits & 0xFull) | (unsigned(bits >> 48u) << 4u);
+}
+}
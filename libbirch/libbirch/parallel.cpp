@@ -0,0 +1,281 @@
+/**
+ * @file
+ */
+#include "libbirch/parallel.hpp"
+
+#include "libbirch/Atomic.hpp"
+#include "libbirch/Lock.hpp"
+
+#include <deque>
+#include <thread>
+#include <random>
+
+/**
+ * Parallel loop in progress.
+ */
+struct Loop {
+  Loop(const libbirch::LoopBody& body, const int64_t from, const int64_t n,
+      const int64_t nranges, const uint64_t seed) :
+      body(body),
+      from(from),
+      n(n),
+      nranges(nranges),
+      seed(seed),
+      remaining(nranges) {
+    //
+  }
+
+  /**
+   * Loop body.
+   */
+  libbirch::LoopBody body;
+
+  /**
+   * First iteration.
+   */
+  int64_t from;
+
+  /**
+   * Number of iterations.
+   */
+  int64_t n;
+
+  /**
+   * Number of ranges into which the iterations are partitioned.
+   */
+  int64_t nranges;
+
+  /**
+   * Seed from which the pseudorandom number stream of each range is
+   * derived.
+   */
+  uint64_t seed;
+
+  /**
+   * Number of ranges not yet completed. The worker that started the loop
+   * waits for this to reach zero, so a worker must not access the loop after
+   * decrementing it.
+   */
+  libbirch::Atomic<int64_t> remaining;
+};
+
+/**
+ * Ranges of iterations of a parallel loop, numbered @p first to @p last.
+ */
+struct Task {
+  int64_t first;
+  int64_t last;
+  Loop* loop;
+};
+
+/**
+ * Deque of tasks for a worker. The worker pushes and pops at the back, other
+ * workers steal from the front.
+ */
+struct alignas(64) Deque {
+  void push(const Task& task) {
+    lock.set();
+    tasks.push_back(task);
+    lock.unset();
+  }
+
+  bool pop(Task& task) {
+    bool found = false;
+    lock.set();
+    if (!tasks.empty()) {
+      task = tasks.back();
+      tasks.pop_back();
+      found = true;
+    }
+    lock.unset();
+    return found;
+  }
+
+  bool steal(Task& task) {
+    bool found = false;
+    lock.set();
+    if (!tasks.empty()) {
+      task = tasks.front();
+      tasks.pop_front();
+      found = true;
+    }
+    lock.unset();
+    return found;
+  }
+
+  libbirch::Lock lock;
+  std::deque<Task> tasks;
+};
+
+/**
+ * Get the deques, one per thread. These are resized by the outermost loop,
+ * before starting the workers, should the number of threads have grown.
+ */
+static std::vector<Deque>& get_deques() {
+  static std::vector<Deque> deques;
+  return deques;
+}
+
+/**
+ * Pseudorandom number generator of the current thread, seeded with entropy
+ * on first use.
+ */
+static std::mt19937_64& get_thread_rng() {
+  static thread_local std::mt19937_64 rng(std::random_device{}());
+  return rng;
+}
+
+/**
+ * Pseudorandom number generator of the range of iterations of a parallel
+ * loop that the current thread is running, or null if it is not running
+ * one.
+ */
+static thread_local std::mt19937_64* range_rng = nullptr;
+
+/**
+ * Number of the current thread as a worker in the scheduler, or -1 if it is
+ * not a worker. This is set on entry to the scheduler rather than queried
+ * with get_thread_num(), which may change if the body of a loop starts its
+ * own OpenMP parallel region.
+ */
+static thread_local int worker = -1;
+
+/**
+ * Is the current thread in an OpenMP parallel region?
+ */
+static bool in_parallel() {
+  #ifdef _OPENMP
+  return omp_in_parallel();
+  #else
+  return false;
+  #endif
+}
+
+/**
+ * Run a task on the current worker.
+ */
+static void run(Task task) {
+  auto& deque = get_deques()[worker];
+  auto loop = task.loop;
+  while (task.last > task.first) {
+    auto mid = task.first + (task.last - task.first + 1)/2;
+    deque.push(Task{mid, task.last, loop});
+    task.last = mid - 1;
+  }
+  libbirch::run_range(loop->body, loop->from, loop->n, loop->nranges,
+      loop->seed, task.first);
+  loop->remaining.subtract(1);
+}
+
+/**
+ * Find a task for the current worker, first from its own deque, then by
+ * stealing from those of other workers.
+ */
+static bool find(Task& task) {
+  auto& deques = get_deques();
+  int nworkers = deques.size();
+  if (deques[worker].pop(task)) {
+    return true;
+  }
+  for (int i = 1; i < nworkers; ++i) {
+    if (deques[(worker + i) % nworkers].steal(task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Run tasks on the current worker until a loop is complete.
+ */
+static void join(Loop* loop) {
+  Task task;
+  while (loop->remaining.load() > 0) {
+    if (find(task)) {
+      run(task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+std::mt19937_64& libbirch::get_rng() {
+  return range_rng ? *range_rng : get_thread_rng();
+}
+
+void libbirch::run_range(const LoopBody& body, const int64_t from,
+    const int64_t n, const int64_t nranges, const uint64_t seed,
+    const int64_t r) {
+  /* splitmix64, so that streams of neighboring ranges are well separated */
+  uint64_t z = seed + uint64_t(r + 1)*0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27))*0x94D049BB133111EBull;
+  z = z ^ (z >> 31);
+  std::mt19937_64 rng(z);
+
+  auto prev = range_rng;
+  range_rng = &rng;
+  body.run(body.closure, r, from + r*n/nranges, from + (r + 1)*n/nranges - 1);
+  range_rng = prev;
+}
+
+void libbirch::parallel_for(const int64_t from, const int64_t to,
+    const int64_t grain, const LoopBody& body) {
+  int64_t n = to - from + 1;
+  if (n <= 0) {
+    return;
+  }
+  int nthreads = get_max_threads();
+  auto nranges = loop_ranges(n, grain);
+  auto seed = get_rng()();
+  if (worker < 0 && (nranges == 1 || nthreads == 1 || in_parallel())) {
+    /* not in the scheduler, and cannot or need not start it */
+    for (int64_t r = 0; r < nranges; ++r) {
+      run_range(body, from, n, nranges, seed, r);
+    }
+    return;
+  }
+
+  Loop loop(body, from, n, nranges, seed);
+  if (worker >= 0) {
+    /* nested loop, run on the existing workers */
+    run(Task{0, nranges - 1, &loop});
+    join(&loop);
+  } else {
+    /* outermost loop, start the workers */
+    auto& deques = get_deques();
+    if (int(deques.size()) < nthreads) {
+      std::vector<Deque>(nthreads).swap(deques);
+    }
+    #pragma omp parallel num_threads(nthreads)
+    {
+      worker = get_thread_num();
+      if (worker == 0) {
+        run(Task{0, nranges - 1, &loop});
+      }
+      join(&loop);
+      worker = -1;
+    }
+  }
+}
+
+void libbirch::parallel_for_openmp(const int64_t from, const int64_t to,
+    const int64_t grain, const LoopBody& body) {
+  int64_t n = to - from + 1;
+  if (n <= 0) {
+    return;
+  }
+  auto nranges = loop_ranges(n, grain);
+  auto seed = get_rng()();
+  if (grain > 0) {
+    #pragma omp parallel for schedule(dynamic)
+    for (int64_t r = 0; r < nranges; ++r) {
+      run_range(body, from, n, nranges, seed, r);
+    }
+  } else {
+    #pragma omp parallel for schedule(static)
+    for (int64_t r = 0; r < nranges; ++r) {
+      run_range(body, from, n, nranges, seed, r);
+    }
+  }
+}
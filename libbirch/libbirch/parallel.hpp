@@ -0,0 +1,353 @@
+/**
+ * @file
+ *
+ * Parallel loops, scheduled by work stealing.
+ */
+#pragma once
+
+#include "libbirch/external.hpp"
+#include "libbirch/thread.hpp"
+
+#include <random>
+
+/**
+ * @def LIBBIRCH_WORK_STEALING
+ *
+ * Set to true for parallel loops to be scheduled by the LibBirch work
+ * stealing scheduler, which supports nested parallel loops, or false to fall
+ * back to an OpenMP worksharing loop, under which nested parallel loops run
+ * serially.
+ *
+ * This is set with `--disable-work-stealing` when configuring packages.
+ */
+#ifndef LIBBIRCH_WORK_STEALING
+#define LIBBIRCH_WORK_STEALING 1
+#endif
+
+namespace libbirch {
+/**
+ * Type-erased body of a parallel loop.
+ *
+ * @ingroup libbirch
+ */
+struct LoopBody {
+  /**
+   * Function that runs the iterations @p from to @p to, inclusive, of the
+   * loop with the given closure. These are the iterations of range number
+   * @p r.
+   */
+  void (*run)(const void* closure, const int64_t r, const int64_t from,
+      const int64_t to);
+
+  /**
+   * Closure.
+   */
+  const void* closure;
+};
+
+/**
+ * Get the pseudorandom number generator for the current thread. Within the
+ * body of a parallel loop, this is the stream of the range of iterations
+ * being run (see parallel_for()), otherwise it is the generator of the
+ * thread.
+ *
+ * @ingroup libbirch
+ */
+std::mt19937_64& get_rng();
+
+/**
+ * Number of ranges into which the iterations of a parallel loop are
+ * partitioned.
+ *
+ * @ingroup libbirch
+ *
+ * @param n Number of iterations.
+ * @param grain Grain size.
+ */
+inline int64_t loop_ranges(const int64_t n, const int64_t grain) {
+  if (grain > 0) {
+    return (n + grain - 1)/grain;
+  } else {
+    return std::min(n, int64_t(get_max_threads()));
+  }
+}
+
+/**
+ * Run one range of iterations of a parallel loop, drawing from its own
+ * stream of pseudorandom numbers.
+ *
+ * @ingroup libbirch
+ *
+ * @param body Loop body.
+ * @param from First index of the loop.
+ * @param n Number of iterations of the loop.
+ * @param nranges Number of ranges into which the iterations are partitioned.
+ * @param seed Seed of the loop, from which the stream of each range is
+ * derived.
+ * @param r Number of the range, from zero.
+ */
+void run_range(const LoopBody& body, const int64_t from, const int64_t n,
+    const int64_t nranges, const uint64_t seed, const int64_t r);
+
+/**
+ * Run a parallel loop with the work stealing scheduler.
+ *
+ * @ingroup libbirch
+ *
+ * @param from First index.
+ * @param to Last index.
+ * @param grain Grain size; the iterations are partitioned into ranges of
+ * this many, or zero to partition them statically into one range per
+ * thread.
+ * @param body Loop body.
+ *
+ * The iterations are partitioned into contiguous ranges that depend only on
+ * the number of iterations, the grain size and, for a grain size of zero,
+ * the number of threads. Each range draws from its own stream of
+ * pseudorandom numbers, seeded from a single draw from the stream of the
+ * caller. Which worker runs each range does not affect the results, then, so
+ * that a seeded program is reproducible for a given number of threads, and,
+ * where all of its parallel loops have a nonzero grain size, for any number
+ * of threads. A parallel loop nested in the body of another draws its seed
+ * from the stream of the enclosing range, and so is reproducible too.
+ *
+ * The outermost parallel loop starts a team of get_max_threads() workers,
+ * each with its own deque of tasks, each task a block of consecutive ranges.
+ * A worker splits a block in half repeatedly, pushing the upper half onto
+ * its deque, until one range remains, then runs it; when its deque is empty
+ * it steals from the front of the deque of another worker, where the
+ * largest blocks are. A parallel loop nested in the body of another runs on
+ * the same team, so that get_thread_num() continues to identify the worker
+ * uniquely for the purposes of thread-local memory pools and stack traces,
+ * and threads are not oversubscribed. A worker waiting for the ranges of a
+ * nested loop to complete runs other tasks in the meantime. A loop of a
+ * single range, or on a single thread, runs on the calling thread without
+ * starting the team.
+ */
+void parallel_for(const int64_t from, const int64_t to, const int64_t grain,
+    const LoopBody& body);
+
+/**
+ * Run a parallel loop with an OpenMP worksharing loop, under which a
+ * parallel loop nested in the body of another runs serially. The iterations
+ * are partitioned into ranges, each with its own stream of pseudorandom
+ * numbers, as for parallel_for(), so that results are the same as with the
+ * work stealing scheduler.
+ *
+ * @ingroup libbirch
+ *
+ * @param from First index.
+ * @param to Last index.
+ * @param grain Grain size, as for parallel_for().
+ * @param body Loop body.
+ */
+void parallel_for_openmp(const int64_t from, const int64_t to,
+    const int64_t grain, const LoopBody& body);
+
+/**
+ * Run a parallel loop.
+ *
+ * @ingroup libbirch
+ *
+ * @tparam Body Callable type taking an index.
+ *
+ * @param from First index.
+ * @param to Last index.
+ * @param grain Grain size. Zero to partition statically, one for the finest
+ * granularity, for loops where the work per iteration is uneven.
+ * @param body Loop body.
+ */
+template<class Body>
+void parallel_for(const int64_t from, const int64_t to, const int64_t grain,
+    const Body& body) {
+  LoopBody erased;
+  erased.run = [](const void* closure, const int64_t r, const int64_t from,
+      const int64_t to) {
+    auto& body = *static_cast<const Body*>(closure);
+    for (auto i = from; i <= to; ++i) {
+      body(i);
+    }
+  };
+  erased.closure = &body;
+  #if LIBBIRCH_WORK_STEALING
+  parallel_for(from, to, grain, erased);
+  #else
+  parallel_for_openmp(from, to, grain, erased);
+  #endif
+}
+
+/**
+ * Is a type one that a reduction may be applied to, i.e. Real or, where
+ * @p integral, Integer? This catches variables declared with `let`, the
+ * types of which are not known to the driver.
+ *
+ * @ingroup libbirch
+ */
+template<class T, bool integral = true>
+struct is_reducible {
+  static const bool value = std::is_same<T,double>::value ||
+      (integral && std::is_same<T,int64_t>::value);
+};
+
+/**
+ * Sum reduction, for parallel_reduce().
+ *
+ * @ingroup libbirch
+ */
+struct SumReduction {
+  template<class T>
+  static T identity() {
+    static_assert(is_reducible<T>::value,
+        "reduction must be sum(x), max(x) or log_sum_exp(x), where x is a "
+        "local variable of type Real or Integer, or of type Real for "
+        "log_sum_exp(x)");
+    return T(0);
+  }
+
+  template<class T>
+  static T combine(const T& x, const T& y) {
+    return x + y;
+  }
+};
+
+/**
+ * Maximum reduction, for parallel_reduce().
+ *
+ * @ingroup libbirch
+ */
+struct MaxReduction {
+  template<class T>
+  static T identity() {
+    static_assert(is_reducible<T>::value,
+        "reduction must be sum(x), max(x) or log_sum_exp(x), where x is a "
+        "local variable of type Real or Integer, or of type Real for "
+        "log_sum_exp(x)");
+    return std::numeric_limits<T>::has_infinity ?
+        -std::numeric_limits<T>::infinity() :
+        std::numeric_limits<T>::lowest();
+  }
+
+  template<class T>
+  static T combine(const T& x, const T& y) {
+    return std::max(x, y);
+  }
+};
+
+/**
+ * Log-sum-exp reduction, for parallel_reduce(). Combines @f$x@f$ and
+ * @f$y@f$ to give @f$\log(\exp(x) + \exp(y))@f$, computed stably.
+ *
+ * @ingroup libbirch
+ */
+struct LogSumExpReduction {
+  template<class T>
+  static T identity() {
+    static_assert(is_reducible<T,false>::value,
+        "reduction must be sum(x), max(x) or log_sum_exp(x), where x is a "
+        "local variable of type Real or Integer, or of type Real for "
+        "log_sum_exp(x)");
+    return -std::numeric_limits<T>::infinity();
+  }
+
+  template<class T>
+  static T combine(const T& x, const T& y) {
+    auto mx = std::max(x, y);
+    if (std::isinf(mx)) {
+      return mx;
+    } else {
+      return mx + std::log1p(std::exp(std::min(x, y) - mx));
+    }
+  }
+};
+
+/**
+ * Run a parallel loop with reductions.
+ *
+ * @ingroup libbirch
+ *
+ * @see parallel_reduce()
+ */
+template<class... Op, class... T, class Body, size_t... I>
+void parallel_reduce(const int64_t from, const int64_t to,
+    const int64_t grain, const std::tuple<T&...>& values, const Body& body,
+    const std::index_sequence<I...>&) {
+  using Partial = std::tuple<T...>;
+  struct Closure {
+    static void combine(Partial& x, const Partial& y) {
+      int expand[] = { (std::get<I>(x) = Op::combine(std::get<I>(x),
+          std::get<I>(y)), 0)... };
+      (void)expand;
+    }
+
+    const Body& body;
+    std::vector<Partial>& partials;
+    const Partial& identity;
+  };
+  const Partial identity(Op::template identity<T>()...);
+  int64_t n = to - from + 1;
+  std::vector<Partial> partials(n > 0 ? loop_ranges(n, grain) : 0,
+      identity);
+
+  Closure closure{body, partials, identity};
+  LoopBody erased;
+  erased.run = [](const void* closure, const int64_t r, const int64_t from,
+      const int64_t to) {
+    auto& c = *static_cast<const Closure*>(closure);
+    auto partial = c.identity;
+    for (auto i = from; i <= to; ++i) {
+      c.body(i, std::get<I>(partial)...);
+    }
+    c.partials[r] = partial;
+  };
+  erased.closure = &closure;
+  #if LIBBIRCH_WORK_STEALING
+  parallel_for(from, to, grain, erased);
+  #else
+  parallel_for_openmp(from, to, grain, erased);
+  #endif
+
+  /* tree combine of the partials for the ranges, in an order that does not
+   * depend on which threads ran them */
+  if (!partials.empty()) {
+    for (size_t stride = 1; stride < partials.size(); stride *= 2) {
+      for (size_t j = 0; j + stride < partials.size(); j += 2*stride) {
+        Closure::combine(partials[j], partials[j + stride]);
+      }
+    }
+    int expand[] = { (std::get<I>(values) = Op::combine(std::get<I>(values),
+        std::get<I>(partials[0])), 0)... };
+    (void)expand;
+  }
+}
+
+/**
+ * Run a parallel loop with reductions.
+ *
+ * @ingroup libbirch
+ *
+ * @tparam Op Reduction types, e.g. SumReduction.
+ * @tparam T Value types.
+ * @tparam Body Callable type taking an index, then a reference to a partial
+ * value for each reduction.
+ *
+ * @param from First index.
+ * @param to Last index.
+ * @param grain Grain size, as for parallel_for().
+ * @param values References to the variables to reduce into, e.g. from
+ * `std::tie()`.
+ * @param body Loop body.
+ *
+ * Each range of iterations, as partitioned by parallel_for(), accumulates
+ * into its own partial values, starting from the identity of each
+ * reduction. Once the loop is complete, the partials for the ranges are
+ * combined pairwise in a tree, and the result combined into @p values. The
+ * order of combination depends only on the partition, so that the result
+ * is reproducible, even with floating point rounding.
+ */
+template<class... Op, class... T, class Body>
+void parallel_reduce(const int64_t from, const int64_t to,
+    const int64_t grain, const std::tuple<T&...>& values, const Body& body) {
+  parallel_reduce<Op...>(from, to, grain, values, body,
+      std::index_sequence_for<T...>());
+}
+}
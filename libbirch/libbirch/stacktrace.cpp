@@ -5,6 +5,16 @@
 
 #include "libbirch/thread.hpp"
 
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <execinfo.h>
+#include <sys/wait.h>
+#ifdef HAVE_LINK_H
+#include <link.h>
+#endif
+
 /**
  * Stack frame.
  */
@@ -41,25 +51,306 @@ void libbirch::abort() {
   abort("assertion failed");
 }
 
-void libbirch::abort(const std::string& msg, const int skip) {
-  printf("error: %s\n", msg.c_str());
-  #ifndef NDEBUG
-  printf("stack trace:\n");
+/*
+ * The functions below that are used by handle_fatal_signal() are restricted
+ * to those that are async-signal-safe: they format into fixed buffers and
+ * output with write(), rather than using printf() or allocating.
+ */
+
+/**
+ * Append a string to a fixed buffer, truncating if necessary.
+ */
+static char* append(char* dst, const char* end, const char* src) {
+  while (dst < end && *src) {
+    *dst++ = *src++;
+  }
+  return dst;
+}
+
+/**
+ * Append an integer to a fixed buffer, truncating if necessary.
+ */
+static char* append(char* dst, const char* end, uintptr_t x,
+    const int base = 10) {
+  char digits[32];
+  int n = 0;
+  do {
+    digits[n++] = "0123456789abcdef"[x % base];
+    x /= base;
+  } while (x > 0);
+  while (dst < end && n > 0) {
+    *dst++ = digits[--n];
+  }
+  return dst;
+}
+
+/**
+ * Write a buffer to standard output.
+ */
+static void write_out(const char* begin, const char* end) {
+  while (begin < end) {
+    auto n = ::write(STDOUT_FILENO, begin, end - begin);
+    if (n <= 0) {
+      break;
+    }
+    begin += n;
+  }
+}
+
+#ifndef NDEBUG
+/**
+ * Print the stack trace of Birch functions for the current thread.
+ *
+ * @param skip Number of frames on the top of the call stack to omit.
+ */
+static void print_frames(const int skip) {
+  char buf[1024];
+  auto end = buf + sizeof(buf);
   auto& trace = get_thread_stack_trace();
   int i = 0;
   for (auto iter = trace.rbegin() + skip; (i < 20 + skip) &&
       iter != trace.rend(); ++iter) {
+    auto ptr = append(buf, end, "    ");
+    ptr = append(ptr, end, iter->func);
     if (iter->file) {
-      printf("    %-24s @ %s:%d\n", iter->func, iter->file, iter->line);
-    } else {
-      printf("    %-24s\n", iter->func);
+      ptr = append(ptr, end, " @ ");
+      ptr = append(ptr, end, iter->file);
+      ptr = append(ptr, end, ":");
+      ptr = append(ptr, end, iter->line);
     }
+    ptr = append(ptr, end, "\n");
+    write_out(buf, ptr);
     ++i;
   }
   if (i < (int)trace.size() - skip) {
-    int rem = (int)trace.size() - skip - i;
-    printf("  + %d more\n", rem);
+    auto ptr = append(buf, end, "  + ");
+    ptr = append(ptr, end, (int)trace.size() - skip - i);
+    ptr = append(ptr, end, " more\n");
+    write_out(buf, ptr);
+  }
+}
+#else
+/**
+ * Maximum number of native stack frames to resolve.
+ */
+static const int max_native_frames = 64;
+
+#ifdef HAVE_LINK_H
+/**
+ * Loaded object, as recorded for resolving addresses.
+ */
+struct loaded_object {
+  char path[512];
+  uintptr_t base, begin, end;
+};
+
+/**
+ * Loaded objects, recorded in advance by record_loaded_objects() so that
+ * they are available within a signal handler.
+ */
+static loaded_object loaded_objects[128];
+static int nloaded_objects = 0;
+
+/**
+ * Record the loaded objects.
+ */
+static void record_loaded_objects() {
+  nloaded_objects = 0;
+  dl_iterate_phdr([](dl_phdr_info* info, size_t, void*) {
+    if (nloaded_objects == 128) {
+      return 1;
+    }
+    auto& o = loaded_objects[nloaded_objects];
+    o.begin = UINTPTR_MAX;
+    o.end = 0;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+      auto& phdr = info->dlpi_phdr[i];
+      if (phdr.p_type == PT_LOAD) {
+        uintptr_t begin = info->dlpi_addr + phdr.p_vaddr;
+        o.begin = std::min(o.begin, begin);
+        o.end = std::max(o.end, uintptr_t(begin + phdr.p_memsz));
+      }
+    }
+    /* the main program has an empty name */
+    auto name = info->dlpi_name && *info->dlpi_name ? info->dlpi_name :
+        "/proc/self/exe";
+    auto end = append(o.path, o.path + sizeof(o.path) - 1, name);
+    *end = '\0';
+    o.base = info->dlpi_addr;
+    ++nloaded_objects;
+    return 0;
+  }, nullptr);
+}
+
+/**
+ * Build a shell command to resolve native stack frames to Birch source
+ * locations. The generated C++ has `#line` directives back to the Birch
+ * source, so that, when built with debugging information, these locations
+ * are in Birch code. Resolution only happens on failure, so that there is no
+ * runtime cost to tracing otherwise.
+ *
+ * Addresses are relative to the base of each object, which is zero for
+ * an executable that is not position-independent; less one to land on the
+ * call instruction rather than the return address.
+ *
+ * @return End of the command in the buffer.
+ */
+static char* resolve_command(char* buf, const char* end, void** addrs,
+    const int n) {
+  auto ptr = append(buf, end, "{ ");
+  for (int j = 0; j < n; ++j) {
+    auto addr = (uintptr_t)addrs[j] - 1;
+    for (int k = 0; k < nloaded_objects; ++k) {
+      auto& o = loaded_objects[k];
+      if (o.begin <= addr && addr < o.end) {
+        ptr = append(ptr, end, "addr2line -C -f -i -p -e '");
+        ptr = append(ptr, end, o.path);
+        ptr = append(ptr, end, "' 0x");
+        ptr = append(ptr, end, addr - o.base, 16);
+        ptr = append(ptr, end, "; ");
+        break;
+      }
+    }
+  }
+  ptr = append(ptr, end, "} 2>/dev/null | sed -n 's/^\\(birch::\\)\\{0,1\\}"
+      "\\([^( ]*\\).* at \\(.*\\.birch:[0-9]*\\).*/    \\2 @ \\3/p' | "
+      "head -n 20");
+  return ptr;
+}
+#endif
+
+/**
+ * Print the native stack trace, resolved to Birch source locations where
+ * possible.
+ *
+ * @param addrs Return addresses.
+ * @param n Number of return addresses.
+ */
+static void print_frames(void** addrs, const int n) {
+  #ifdef HAVE_LINK_H
+  if (nloaded_objects > 0) {
+    static char cmd[16384];
+    auto end = resolve_command(cmd, cmd + sizeof(cmd) - 1, addrs, n);
+    *end = '\0';
+    auto pid = fork();
+    if (pid == 0) {
+      const char* argv[] = { "/bin/sh", "-c", cmd, nullptr };
+      execv(argv[0], const_cast<char**>(argv));
+      _exit(127);
+    } else if (pid > 0) {
+      int status;
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        //
+      }
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        return;
+      }
+    }
+  }
+  #endif
+
+  /* fall back to the symbols of the native frames */
+  backtrace_symbols_fd(addrs, n, STDOUT_FILENO);
+}
+#endif
+
+/**
+ * Print the stack trace for the current thread. This is async-signal-safe,
+ * for use by handle_fatal_signal().
+ *
+ * @param skip Number of frames on the top of the call stack to omit.
+ */
+static void print_stack_trace(const int skip) {
+  const char header[] = "stack trace:\n";
+  write_out(header, header + sizeof(header) - 1);
+  #ifndef NDEBUG
+  print_frames(skip);
+  #else
+  /* in a release build there is no stack trace of Birch functions, resolve
+   * the native stack instead; skip this function and its caller too */
+  void* addrs[max_native_frames];
+  int n = backtrace(addrs, max_native_frames);
+  int first = std::min(skip + 2, n);
+  print_frames(addrs + first, n - first);
+  #endif
+}
+
+/**
+ * Handle a fatal signal by printing the stack trace, then raising it again
+ * with the default handler, which is restored on entry (SA_RESETHAND).
+ */
+static void handle_fatal_signal(int sig) {
+  const char* name = "fatal signal";
+  switch (sig) {
+  case SIGSEGV:
+    name = "segmentation fault";
+    break;
+  case SIGBUS:
+    name = "bus error";
+    break;
+  case SIGFPE:
+    name = "floating point exception";
+    break;
+  case SIGILL:
+    name = "illegal instruction";
+    break;
+  }
+  char buf[64];
+  auto end = buf + sizeof(buf);
+  auto ptr = append(buf, end, "error: ");
+  ptr = append(ptr, end, name);
+  ptr = append(ptr, end, "\n");
+  write_out(buf, ptr);
+  print_stack_trace(0);
+  raise(sig);
+}
+
+void libbirch::install_signal_handlers() {
+  #ifdef NDEBUG
+  /* backtrace() may allocate on first use, as it loads its unwinder, so
+   * call it once now rather than first in a signal handler */
+  void* addrs[1];
+  backtrace(addrs, 1);
+  #ifdef HAVE_LINK_H
+  record_loaded_objects();
+  #endif
+  #endif
+
+  /* alternate stack, so that the handler can run on stack overflow; this
+   * is for the calling thread only */
+  static char altstack[1 << 16];
+  stack_t ss;
+  if (sigaltstack(nullptr, &ss) == 0 && (ss.ss_flags & SS_DISABLE)) {
+    ss.ss_sp = altstack;
+    ss.ss_size = sizeof(altstack);
+    ss.ss_flags = 0;
+    sigaltstack(&ss, nullptr);
   }
+
+  /* install only where no other handler is installed, so as not to
+   * override those of a host program */
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = handle_fatal_signal;
+  action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+  sigemptyset(&action.sa_mask);
+  for (int sig : { SIGSEGV, SIGBUS, SIGFPE, SIGILL }) {
+    struct sigaction old;
+    if (sigaction(sig, nullptr, &old) == 0 && old.sa_handler == SIG_DFL &&
+        !(old.sa_flags & SA_SIGINFO)) {
+      sigaction(sig, &action, nullptr);
+    }
+  }
+}
+
+void libbirch::abort(const std::string& msg, const int skip) {
+  printf("error: %s\n", msg.c_str());
+  fflush(stdout);
+  #if defined(NDEBUG) && defined(HAVE_LINK_H)
+  record_loaded_objects();  // may have changed since installation
+  #endif
+  print_stack_trace(skip);
+  #ifndef NDEBUG
   assert(false);
   #else
   std::exit(1);
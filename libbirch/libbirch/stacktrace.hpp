@@ -10,6 +10,11 @@
  * @def libbirch_function_
  *
  * Push a new frame onto the stack trace.
+ *
+ * In release builds this is empty, so that there is no runtime cost; on
+ * failure, the stack trace is instead recovered from the native stack, and
+ * resolved to Birch source locations with the debugging information of the
+ * library, if any.
  */
 #ifndef NDEBUG
 #define libbirch_function_(func, file, n) libbirch::StackFunction function_(func, file, n)
@@ -20,7 +25,8 @@
 /**
  * @def libbirch_line_
  *
- * Update the line number of the top frame of the stack trace.
+ * Update the line number of the top frame of the stack trace. In release
+ * builds this is empty.
  */
 #ifndef NDEBUG
 #define libbirch_line_(n) libbirch::line(n)
@@ -55,4 +61,13 @@ void abort();
  * stack trace.
  */
 void abort(const std::string& msg, const int skip = 0);
+
+/**
+ * Install handlers for fatal signals (segmentation fault, bus error,
+ * floating point exception, illegal instruction) that print a stack trace.
+ * Handlers are installed only for those signals that have the default
+ * disposition, so as not to override those of a host program. This is called
+ * at the start of each program.
+ */
+void install_signal_handlers();
 }
@@ -13,3 +13,6 @@ ls src/test/conjugacy | grep '\.birch' | sed "s/.birch$/ -N $N --lazy false/g" |
 ls src/test/conjugacy | grep '\.birch' | sed "s/.birch$/ -N $N --lazy true/g"  | xargs -t -L 1 -P $P birch
 ls src/test/cdf       | grep '\.birch' | sed "s/.birch$/ -N $N/g"              | xargs -t -L 1 -P $P birch
 ls src/test/grad      | grep '\.birch' | sed "s/.birch$/ -N $M/g"              | xargs -t -L 1 -P $P birch
+
+# programs that should fail to compile
+test/error.sh
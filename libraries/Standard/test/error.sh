@@ -0,0 +1,21 @@
+#!/bin/bash
+set -eo pipefail
+
+# programs that should fail to compile, with the expected error on the first
+# line of each, as a comment; run from the root directory of the package
+for file in test/error/*.birch; do
+  dir=$(mktemp -d)
+  cp $file $dir
+  printf "name: Error\nmanifest:\n  source:\n    - %s\nrequire:\n  package:\n    - Standard\n" $(basename $file) > $dir/birch.yml
+  expected=$(head -n 1 $file | sed -e 's|^/\* *||' -e 's| *\*/$||')
+  echo "birch bootstrap # $file"
+  if (cd $dir && birch bootstrap) > $dir/output.txt 2>&1; then
+    echo "$file: compiled, but should have failed with: $expected"
+    exit 1
+  elif ! grep -qF "$expected" $dir/output.txt; then
+    cat $dir/output.txt
+    echo "$file: failed, but without: $expected"
+    exit 1
+  fi
+  rm -rf $dir
+done